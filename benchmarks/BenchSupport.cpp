@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "BenchSupport.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+// the type families the generated library draws on.  Each line is a
+// related.txt group, and the first ten of them are long enough that
+// substituting within the family matters.
+static const char *const kFamilies[] = {
+	"B731 B732 B733 B734 B735 B736 B737 B738 B739",
+	"A318 A319 A320 A321",
+	"A332 A333 A338 A339",
+	"B752 B753 B762 B763 B764",
+	"B772 B773 B77L B77W B788 B789",
+	"E170 E175 E190 E195",
+	"CRJ1 CRJ2 CRJ7 CRJ9",
+	"DH8A DH8B DH8C DH8D",
+	"AT43 AT45 AT72 AT76",
+	"C150 C152 C172 C182 C206 C208",
+	"B744 B748",
+	"A343 A346",
+	"MD11",
+	"A388",
+	"PA28",
+	"SR22",
+};
+
+static const char *const kAirlines[] = {
+	"AAL", "BAW", "DLH", "AFR", "KLM", "UAL", "DAL", "SWA", "RYR", "EZY",
+	"QFA", "ANZ", "JAL", "ANA", "SIA", "CPA", "UAE", "QTR", "THY", "ACA",
+	"IBE", "AUA", "SAS", "FIN", "TAP", "AZA", "VIR", "JBU", "ASA", "WJA",
+};
+
+static const int kLiveriesPerAirline = 4;
+
+std::string
+Bench_SystemPath()
+{
+	static const std::string sPath = [] {
+		const fs::path path = fs::temp_directory_path() / "xpmp_bench_xplane";
+		fs::create_directories(path);
+		return path.string() + "/";
+	}();
+	return sPath;
+}
+
+std::string
+Bench_TempDir(const char *name)
+{
+	const fs::path path = fs::path(Bench_SystemPath()) / name;
+	fs::remove_all(path);
+	fs::create_directories(path);
+	return path.string();
+}
+
+void
+Bench_RemoveDir(const std::string &path)
+{
+	std::error_code error;
+	fs::remove_all(path, error);
+}
+
+static std::ofstream
+OpenForWriting(const fs::path &path)
+{
+	std::ofstream out(path);
+	if (!out) {
+		throw std::runtime_error("couldn't write " + path.string());
+	}
+	return out;
+}
+
+SyntheticLibrary
+Bench_WriteLibrary(const std::string &root, int packageCount, int modelsPerPackage)
+{
+	SyntheticLibrary library;
+	const fs::path rootPath(root);
+	library.cslPath = (rootPath / "CSL").string();
+	library.relatedPath = (rootPath / "related.txt").string();
+	library.doc8643Path = (rootPath / "Doc8643.txt").string();
+	library.modelCount = 0;
+
+	{
+		std::ofstream related = OpenForWriting(library.relatedPath);
+		std::ofstream doc8643 = OpenForWriting(library.doc8643Path);
+		related << "; generated for the benchmarks\n";
+		for (const char *family: kFamilies) {
+			related << family << "\n";
+			std::string icaos(family);
+			for (size_t start = 0; start < icaos.size();) {
+				size_t end = icaos.find(' ', start);
+				if (end == std::string::npos) {
+					end = icaos.size();
+				}
+				const std::string icao = icaos.substr(start, end - start);
+				library.icaos.push_back(icao);
+				doc8643 << "MFR\tNAME\t" << icao << "\tL2J\tM\n";
+				start = end + 1;
+			}
+		}
+	}
+	for (const char *airline: kAirlines) {
+		library.airlines.emplace_back(airline);
+	}
+	for (int n = 0; n < kLiveriesPerAirline; ++n) {
+		library.liveries.push_back("L" + std::to_string(n));
+	}
+
+	// a small linear congruential generator, so the library's the same on
+	// every platform.
+	uint32_t seed = 12345;
+	auto next = [&seed](size_t range) {
+		seed = seed * 1103515245u + 12345u;
+		return static_cast<size_t>((seed >> 16) % range);
+	};
+
+	for (int package = 0; package < packageCount; ++package) {
+		char name[16];
+		snprintf(name, sizeof(name), "PKG%03d", package);
+		const fs::path packagePath = fs::path(library.cslPath) / name;
+		fs::create_directories(packagePath / "objs");
+		std::ofstream out = OpenForWriting(packagePath / "xsb_aircraft.txt");
+		out << "EXPORT_NAME " << name << "\n";
+
+		// the last package covers every type, the way the usual fallback
+		// packages do, so every query finds something.
+		const bool fallback = (package == packageCount - 1);
+		const size_t count = fallback ? library.icaos.size() : static_cast<size_t>(modelsPerPackage);
+		for (size_t model = 0; model < count; ++model) {
+			const std::string &icao = fallback ? library.icaos[model] : library.icaos[next(library.icaos.size())];
+			out << "\nOBJ8_AIRCRAFT m" << model << "\n";
+			out << "OBJ8 SOLID YES " << name << "/objs/" << icao << ".obj\n";
+			if (fallback) {
+				out << "ICAO " << icao << "\n";
+			} else {
+				const std::string &airline = library.airlines[next(library.airlines.size())];
+				switch (next(3)) {
+				case 0:
+					out << "ICAO " << icao << "\n";
+					break;
+				case 1:
+					out << "AIRLINE " << icao << " " << airline << "\n";
+					break;
+				default:
+					out << "LIVERY " << icao << " " << airline << " " << library.liveries[next(library.liveries.size())] << "\n";
+					break;
+				}
+			}
+			++library.modelCount;
+		}
+	}
+	return library;
+}
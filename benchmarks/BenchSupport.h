@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef BENCHSUPPORT_H
+#define BENCHSUPPORT_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*
+ * BenchSupport
+ *
+ * Shared helpers for the benchmarks.  These run outside of X-Plane, with
+ * the XPLM functions the library uses replaced by the stubs in
+ * XPLMStubs.cpp, so they measure the library's own work only.
+ */
+
+/** Bench_BestOf runs work reps times and returns the fastest run, in
+ * microseconds.  The best run is the one least disturbed by the rest of the
+ * machine.
+ */
+template<typename Work>
+double
+Bench_BestOf(int reps, Work &&work)
+{
+	double best = 0.0;
+	for (int rep = 0; rep < reps; ++rep) {
+		const auto start = std::chrono::steady_clock::now();
+		work();
+		const double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		if (rep == 0 || elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+/** Bench_SetLogging sends the library's log output to stderr if enabled.
+ * It's discarded by default.
+ */
+void Bench_SetLogging(bool enabled);
+
+/** Bench_SetView sets the matrices the stubbed datarefs report for the
+ * camera.  The camera is at the origin, turned yaw degrees to the right of
+ * looking down -Z, with a vertical field of view of fovY degrees.
+ */
+void Bench_SetView(float yaw, float fovY, float aspect, float nearClip, float farClip);
+
+/** Bench_NextFrame advances the stubbed cycle number and elapsed time by a
+ * frame, so the library treats the next call as a new frame.
+ */
+void Bench_NextFrame();
+
+/** Bench_CompleteLoads runs the callbacks of every object load the stubs
+ * have been asked for.
+ */
+void Bench_CompleteLoads();
+
+/** Bench_SystemPath returns the folder the stubs report as the X-Plane
+ * folder, with a trailing separator.  The library writes its index caches
+ * to Output/caches in it.
+ */
+std::string Bench_SystemPath();
+
+/** Bench_TempDir creates an empty directory for the benchmark to work in,
+ * inside Bench_SystemPath the way a CSL library would be.  It's removed by
+ * Bench_RemoveDir.
+ */
+std::string Bench_TempDir(const char *name);
+void Bench_RemoveDir(const std::string &path);
+
+/** SyntheticLibrary describes a generated CSL library and the data files
+ * to go with it.
+ */
+struct SyntheticLibrary {
+	std::string					cslPath;		// the folder to pass to XPMPLoadCSLPackages
+	std::string					relatedPath;
+	std::string					doc8643Path;
+	std::vector<std::string>	icaos;			// every ICAO code a model uses
+	std::vector<std::string>	airlines;		// every airline code a model uses
+	std::vector<std::string>	liveries;		// every livery code a model uses
+	size_t						modelCount;
+};
+
+/** Bench_WriteLibrary generates a CSL library of packageCount packages with
+ * modelsPerPackage models each under root.  The models are spread over the
+ * same ICAO, airline and livery codes, so the packages overlap the way real
+ * ones do, and the result only depends on the arguments.
+ */
+SyntheticLibrary Bench_WriteLibrary(const std::string &root, int packageCount, int modelsPerPackage);
+
+#endif //BENCHSUPPORT_H
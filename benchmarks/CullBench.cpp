@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/*
+ * CullBench
+ *
+ * Compares the batched frustum test, CullInfo::SpheresVisible, with the
+ * scalar SphereIsVisible and SphereDistanceSqr it's built from, on randomly
+ * placed spheres.  The two must agree exactly, so any difference in
+ * visibility or distance is counted as a mismatch and fails the run.
+ *
+ * It runs at the plane counts the other benchmarks use, and at the 10,000
+ * spheres the batched test was first measured with.
+ *
+ * It then checks the radius is honoured in metres at each edge of the view:
+ * a sphere whose centre is outside an edge by a little less than its radius
+ * must be visible, and one outside by a little more must not be.  Either
+ * test getting that wrong fails the run.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "CullInfo.h"
+
+static const size_t kCounts[] = {100, 1000, 5000, 10000};
+static const size_t kMaxCount = 10000;
+
+static const float kFovY = 60.0f;
+static const float kAspect = 16.0f / 9.0f;
+
+/** CheckEdges places spheres just either side of their radius outside each
+ * of the four edges of a camera looking straight down -Z, and returns how
+ * many of them the scalar or batched tests got wrong.
+ */
+static size_t
+CheckEdges(const CullInfo &camera)
+{
+	const float depths[] = {50.0f, 500.0f, 5000.0f, 20000.0f};
+	const float radii[] = {5.0f, 30.0f};
+	const float outside[] = {0.9f, 1.1f};		// how far out the centre is, in radii
+
+	// each edge is given by its half angle from the view axis, and which
+	// axis and direction it's across.
+	const float halfY = kFovY * static_cast<float>(M_PI) / 360.0f;
+	const float halfX = std::atan(kAspect * std::tan(halfY));
+	struct Edge {
+		const char	*name;
+		float		halfAngle;
+		float		sx, sy;
+	};
+	const Edge edges[] = {
+		{"left", halfX, -1.0f, 0.0f},
+		{"right", halfX, 1.0f, 0.0f},
+		{"bottom", halfY, 0.0f, -1.0f},
+		{"top", halfY, 0.0f, 1.0f},
+	};
+
+	std::vector<float> x, y, z, r;
+	std::vector<uint8_t> expected;
+	for (const auto &edge: edges) {
+		for (const float depth: depths) {
+			for (const float radius: radii) {
+				for (const float out: outside) {
+					// a point on the edge, moved out along the edge plane's
+					// outward normal.
+					const float across = depth * std::tan(edge.halfAngle) + out * radius * std::cos(edge.halfAngle);
+					const float along = -depth + out * radius * std::sin(edge.halfAngle);
+					x.push_back(edge.sx * across);
+					y.push_back(edge.sy * across);
+					z.push_back(along);
+					r.push_back(radius);
+					expected.push_back(out < 1.0f ? 1 : 0);
+				}
+			}
+		}
+	}
+
+	std::vector<uint8_t> batchVisible(x.size());
+	std::vector<float> batchDistance(x.size());
+	camera.SpheresVisible(x.size(), x.data(), y.data(), z.data(), r.data(), batchVisible.data(), batchDistance.data());
+	size_t failures = 0;
+	for (size_t i = 0; i < x.size(); ++i) {
+		const uint8_t scalarVisible = camera.SphereIsVisible(x[i], y[i], z[i], r[i]) ? 1 : 0;
+		if (scalarVisible != expected[i] || batchVisible[i] != expected[i]) {
+			printf("edge check failed: sphere at (%.1f, %.1f, %.1f) radius %.1f should%s be visible\n",
+				x[i], y[i], z[i], r[i], expected[i] ? "" : " not");
+			++failures;
+		}
+	}
+	printf("edge check: %zu spheres, %zu wrong\n", x.size(), failures);
+	return failures;
+}
+
+int
+main()
+{
+	CullInfo::init();
+	Bench_SetView(17.0f, kFovY, kAspect, 1.0f, 50000.0f);
+	const CullInfo camera;
+	Bench_SetView(0.0f, kFovY, kAspect, 1.0f, 50000.0f);
+	const CullInfo straightCamera;
+
+	// spread out far enough that some are beyond the far clip, and flattened
+	// the way traffic is.
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<float> position(-60000.0f, 60000.0f);
+	std::uniform_real_distribution<float> radius(5.0f, 60.0f);
+	std::vector<float> x(kMaxCount), y(kMaxCount), z(kMaxCount), r(kMaxCount);
+	for (size_t i = 0; i < kMaxCount; ++i) {
+		x[i] = position(generator);
+		y[i] = position(generator) / 10.0f;
+		z[i] = position(generator);
+		r[i] = radius(generator);
+	}
+
+	std::vector<uint8_t> scalarVisible(kMaxCount), batchVisible(kMaxCount);
+	std::vector<float> scalarDistance(kMaxCount), batchDistance(kMaxCount);
+	const int kReps = 200;
+	printf("%8s %12s %12s %8s %9s %11s\n", "spheres", "scalar us", "batched us", "speedup", "visible", "mismatches");
+	size_t totalMismatches = 0;
+	for (const size_t count: kCounts) {
+		const double scalarTime = Bench_BestOf(kReps, [&] {
+			for (size_t i = 0; i < count; ++i) {
+				scalarVisible[i] = camera.SphereIsVisible(x[i], y[i], z[i], r[i]) ? 1 : 0;
+				scalarDistance[i] = camera.SphereDistanceSqr(x[i], y[i], z[i]);
+			}
+		});
+		const double batchTime = Bench_BestOf(kReps, [&] {
+			camera.SpheresVisible(count, x.data(), y.data(), z.data(), r.data(), batchVisible.data(), batchDistance.data());
+		});
+
+		size_t visible = 0;
+		size_t mismatches = 0;
+		for (size_t i = 0; i < count; ++i) {
+			visible += batchVisible[i];
+			if (scalarVisible[i] != batchVisible[i] || scalarDistance[i] != batchDistance[i]) {
+				++mismatches;
+			}
+		}
+		totalMismatches += mismatches;
+		printf("%8zu %12.1f %12.1f %7.1fx %9zu %11zu\n", count, scalarTime, batchTime, scalarTime / batchTime, visible, mismatches);
+	}
+	const size_t edgeFailures = CheckEdges(straightCamera);
+	return (totalMismatches || edgeFailures) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
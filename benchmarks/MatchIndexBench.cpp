@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/*
+ * MatchIndexBench
+ *
+ * Compares model matching through the merged match index with the walk over
+ * every package's match table that it replaced, on a generated library.  The
+ * match cache is bypassed, so both sides do a full match for every query,
+ * and the two are checked against each other as they go.
+ *
+ * Usage: MatchIndexBench [packages] [models per package]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "CSL.h"
+#include "CSLLibrary.h"
+#include "PlaneType.h"
+#include "StringAtoms.h"
+#include "XPMPMultiplayer.h"
+#include "XPMPMultiplayerVars.h"
+
+static const int kUseICAO[] = {1, 1, 0, 0, 1, 1, 0, 0};
+static const int kUseAirline[] = {1, 1, 1, 1, 0, 0, 0, 0};
+static const int kUseLivery[] = {1, 0, 1, 0, 1, 0, 1, 0};
+
+/** PackageWalkMatch is the pass stage of model matching as it was before the
+ * index: every pass probes each package's table in priority order.
+ */
+static CSL *
+PackageWalkMatch(const PlaneType &type, int *match_quality)
+{
+	const Atom icao = Atom_Find(type.getICAO());
+	auto groupIter = gGroupings.find(icao);
+	const Atom group = (groupIter == gGroupings.end()) ? kNoAtom : groupIter->second;
+	const Atom airline = Atom_Find(type.getAirline());
+	const Atom livery = type.getLiveryAtom();
+
+	for (int n = 0; n < match_count; ++n) {
+		CSLMatchKey_t key{kUseICAO[n]?icao:group, kNoAtom, kNoAtom};
+		if (!kUseICAO[n] && group == kNoAtom) {
+			continue;
+		}
+		if (kUseAirline[n]) {
+			if (type.getAirline().empty()) {
+				continue;
+			}
+			key.airline = airline;
+		}
+		if (kUseLivery[n]) {
+			if (type.getLivery().empty()) {
+				continue;
+			}
+			key.livery = livery;
+		}
+		for (const auto &package: gPackages) {
+			auto iter = package.matches[n].find(key);
+			if (iter != package.matches[n].end() && package.planes[iter->second]->isUsable()) {
+				*match_quality = n;
+				return package.planes[iter->second];
+			}
+		}
+	}
+	*match_quality = -1;
+	return nullptr;
+}
+
+int
+main(int argc, char **argv)
+{
+	const int packageCount = (argc > 1) ? atoi(argv[1]) : 200;
+	const int modelsPerPackage = (argc > 2) ? atoi(argv[2]) : 50;
+
+	const std::string root = Bench_TempDir("xpmp_match_bench");
+	const SyntheticLibrary library = Bench_WriteLibrary(root, packageCount, modelsPerPackage);
+	XPMPMultiplayerInit(nullptr, library.relatedPath.c_str(), library.doc8643Path.c_str());
+	XPMPLoadCSLPackages(library.cslPath.c_str());
+	printf("%zu packages, %d models\n", gPackages.size(), XPMPGetNumberOfInstalledModels());
+
+	// every known type with each airline and livery, some of them unknown,
+	// so every pass gets its share of hits and misses.
+	std::vector<std::string> airlines(library.airlines);
+	airlines.emplace_back("");
+	airlines.emplace_back("ZZZ");
+	std::vector<std::string> liveries(library.liveries);
+	liveries.emplace_back("");
+	liveries.emplace_back("ZZ");
+	std::vector<PlaneType> queries;
+	for (const auto &icao: library.icaos) {
+		for (const auto &airline: airlines) {
+			for (const auto &livery: liveries) {
+				queries.emplace_back(icao, airline, livery);
+			}
+		}
+	}
+
+	size_t mismatches = 0;
+	for (const auto &type: queries) {
+		int walkQuality = -1;
+		int indexQuality = -1;
+		CSL *walk = PackageWalkMatch(type, &walkQuality);
+		CSL *index = CSL_MatchPlaneUncached(type, &indexQuality, false);
+		if (walk != index || walkQuality != indexQuality) {
+			++mismatches;
+		}
+	}
+
+	const int kReps = 5;
+	size_t found = 0;
+	const double walkTime = Bench_BestOf(kReps, [&] {
+		found = 0;
+		for (const auto &type: queries) {
+			int quality;
+			found += (PackageWalkMatch(type, &quality) != nullptr);
+		}
+	});
+	const double indexTime = Bench_BestOf(kReps, [&] {
+		found = 0;
+		for (const auto &type: queries) {
+			int quality;
+			found += (CSL_MatchPlaneUncached(type, &quality, false) != nullptr);
+		}
+	});
+
+	printf("%zu queries, %zu matched\n", queries.size(), found);
+	printf("package walk: %10.1f us (%.3f us/query)\n", walkTime, walkTime / queries.size());
+	printf("match index:  %10.1f us (%.3f us/query)\n", indexTime, indexTime / queries.size());
+	printf("speedup: %.1fx, mismatches: %zu\n", walkTime / indexTime, mismatches);
+
+	XPMPMultiplayerCleanup();
+	Bench_RemoveDir(root);
+	return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
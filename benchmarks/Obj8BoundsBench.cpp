@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/*
+ * Obj8BoundsBench
+ *
+ * Checks Obj8BoundsReader::readBounds against fixtures/bounds.obj, whose
+ * bounds are worked out by hand in the file, and fails the run if they
+ * don't match.
+ *
+ * It then times readBounds on generated objects the size of typical CSL
+ * models, to show what the background thread spends per model.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "BenchSupport.h"
+#include "obj8/Obj8Bounds.h"
+
+static const int kVertexCounts[] = {1000, 10000, 50000};
+
+/** CheckFixture reads the fixture and compares it with the bounds given in
+ * its comments.
+ */
+static bool
+CheckFixture()
+{
+	const std::string path = std::string(XPMP_BENCH_FIXTURES) + "/bounds.obj";
+	const float expectedMin[3] = {-9.0f, 0.0f, -12.0f};
+	const float expectedMax[3] = {6.0f, 3.0f, 8.0f};
+	const float expectedRadius = std::sqrt(153.0f);
+
+	Obj8Bounds bounds{};
+	if (!Obj8BoundsReader::readBounds(path, bounds)) {
+		printf("fixture check failed: couldn't read %s\n", path.c_str());
+		return false;
+	}
+	bool ok = std::fabs(bounds.radius - expectedRadius) < 1e-4f;
+	for (int axis = 0; axis < 3; ++axis) {
+		ok = ok && bounds.min[axis] == expectedMin[axis] && bounds.max[axis] == expectedMax[axis];
+	}
+	printf("fixture: min (%g, %g, %g) max (%g, %g, %g) radius %.4f (expected %.4f): %s\n",
+		bounds.min[0], bounds.min[1], bounds.min[2],
+		bounds.max[0], bounds.max[1], bounds.max[2],
+		bounds.radius, expectedRadius, ok ? "ok" : "WRONG");
+	return ok;
+}
+
+/** WriteObject writes an object with vertexCount vertices, an index for
+ * each of them, and a handful of lights in the command section.
+ */
+static void
+WriteObject(const std::string &path, int vertexCount)
+{
+	std::ofstream out(path);
+	out << "I\n800\nOBJ\n\nTEXTURE bench.png\n";
+	out << "POINT_COUNTS " << vertexCount << " 0 0 " << vertexCount << "\n\n";
+	for (int i = 0; i < vertexCount; ++i) {
+		const float t = static_cast<float>(i) / vertexCount;
+		out << "VT " << 20.0f * std::cos(t * 40.0f) << " " << 3.0f * t << " " << 20.0f * std::sin(t * 40.0f)
+			<< " 0 1 0 " << t << " " << t << "\n";
+	}
+	out << "\n";
+	int i = 0;
+	for (; i + 10 <= vertexCount; i += 10) {
+		out << "IDX10";
+		for (int n = 0; n < 10; ++n) {
+			out << " " << (i + n);
+		}
+		out << "\n";
+	}
+	for (; i < vertexCount; ++i) {
+		out << "IDX " << i << "\n";
+	}
+	out << "\nATTR_LOD 0 5000\nTRIS 0 " << vertexCount << "\n";
+	for (int light = 0; light < 8; ++light) {
+		out << "LIGHT_NAMED airplane_nav_left_size " << (light - 4) * 4.0f << " 1 -18\n";
+	}
+}
+
+int
+main()
+{
+	const bool fixtureOk = CheckFixture();
+
+	const std::string root = Bench_TempDir("xpmp_bounds_bench");
+	printf("%10s %12s\n", "vertices", "read us");
+	for (const int vertexCount: kVertexCounts) {
+		const std::string path = root + "/object_" + std::to_string(vertexCount) + ".obj";
+		WriteObject(path, vertexCount);
+		Obj8Bounds bounds{};
+		const double elapsed = Bench_BestOf(20, [&] {
+			Obj8BoundsReader::readBounds(path, bounds);
+		});
+		printf("%10d %12.1f\n", vertexCount, elapsed);
+	}
+	Bench_RemoveDir(root);
+	return fixtureOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/*
+ * PackageLoadBench
+ *
+ * Times loading a generated CSL library with the packages parsed on one
+ * thread, and on a pool of one thread per processor (the library's
+ * default), both with the index caches deleted (cold) and with them left
+ * from the previous load (warm).
+ *
+ * Loaded packages can't be unloaded again, so each load is run in a fresh
+ * copy of this program (started with --load) which reports its time back.
+ *
+ * Usage: PackageLoadBench [packages] [models per package] [pool threads]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "BenchSupport.h"
+#include "XPMPMultiplayer.h"
+
+#if IBM
+#define popen _popen
+#define pclose _pclose
+#endif
+
+static const int kReps = 5;
+
+/** LoadLibrary is the --load side: it loads the library once and prints how
+ * long it took, in milliseconds.
+ */
+static int
+LoadLibrary(const char *root, int threads)
+{
+	const std::filesystem::path rootPath(root);
+	XPMPMultiplayerInit(nullptr, (rootPath / "related.txt").string().c_str(), (rootPath / "Doc8643.txt").string().c_str());
+	XPMPConfiguration_t config;
+	XPMPGetConfiguration(&config);
+	config.loaderThreads = threads;
+	XPMPSetConfiguration(&config);
+
+	const auto start = std::chrono::steady_clock::now();
+	const char *error = XPMPLoadCSLPackages((rootPath / "CSL").string().c_str());
+	const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	const int models = XPMPGetNumberOfInstalledModels();
+	XPMPMultiplayerCleanup();
+	if (error != nullptr && error[0] != '\0') {
+		fprintf(stderr, "load failed: %s\n", error);
+		return EXIT_FAILURE;
+	}
+	printf("%f %d\n", elapsed, models);
+	return EXIT_SUCCESS;
+}
+
+/** TimeLoad runs a fresh copy of the program to load the library with
+ * threads loader threads, deleting the caches first if cold is set, and
+ * returns the best time of kReps.
+ */
+static double
+TimeLoad(const char *self, const std::string &root, int threads, bool cold, int *outModels)
+{
+	const std::string command = std::string("\"") + self + "\" --load \"" + root + "\" " + std::to_string(threads);
+	double best = 0.0;
+	for (int rep = 0; rep < kReps; ++rep) {
+		if (cold) {
+			std::error_code error;
+			std::filesystem::remove_all(std::filesystem::path(Bench_SystemPath()) / "Output" / "caches", error);
+		}
+		FILE *child = popen(command.c_str(), "r");
+		double elapsed = 0.0;
+		if (child == nullptr || fscanf(child, "%lf %d", &elapsed, outModels) != 2) {
+			fprintf(stderr, "couldn't run %s\n", command.c_str());
+			exit(EXIT_FAILURE);
+		}
+		pclose(child);
+		if (rep == 0 || elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+int
+main(int argc, char **argv)
+{
+	if (argc == 4 && strcmp(argv[1], "--load") == 0) {
+		return LoadLibrary(argv[2], atoi(argv[3]));
+	}
+	const int packageCount = (argc > 1) ? atoi(argv[1]) : 400;
+	const int modelsPerPackage = (argc > 2) ? atoi(argv[2]) : 50;
+	const int poolThreads = (argc > 3) ? atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+
+	const std::string root = Bench_TempDir("xpmp_load_bench");
+	const SyntheticLibrary library = Bench_WriteLibrary(root, packageCount, modelsPerPackage);
+
+	int models = 0;
+	const double cold1 = TimeLoad(argv[0], root, 1, true, &models);
+	const double warm1 = TimeLoad(argv[0], root, 1, false, &models);
+	printf("%d packages, %d models, best of %d\n", packageCount, models, kReps);
+	if (poolThreads > 1) {
+		const double coldN = TimeLoad(argv[0], root, poolThreads, true, &models);
+		const double warmN = TimeLoad(argv[0], root, poolThreads, false, &models);
+		const std::string poolHeading = std::to_string(poolThreads) + " threads ms";
+		printf("%-12s %12s %12s %8s\n", "", "1 thread ms", poolHeading.c_str(), "speedup");
+		printf("%-12s %12.1f %12.1f %7.1fx\n", "cold cache", cold1, coldN, cold1 / coldN);
+		printf("%-12s %12.1f %12.1f %7.1fx\n", "warm cache", warm1, warmN, warm1 / warmN);
+	} else {
+		printf("%-12s %12s\n", "", "1 thread ms");
+		printf("%-12s %12.1f\n", "cold cache", cold1);
+		printf("%-12s %12.1f\n", "warm cache", warm1);
+		printf("only one processor, so there's no parallel load to compare with.\n"
+			"Pass a thread count as the third argument to time one anyway.\n");
+	}
+
+	Bench_RemoveDir(root);
+	return EXIT_SUCCESS;
+}
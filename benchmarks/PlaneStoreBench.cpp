@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/*
+ * PlaneStoreBench
+ *
+ * Compares the dense PlaneStore with the unordered_map of separately
+ * allocated planes it replaced, at 100, 1,000 and 5,000 planes.  The old
+ * layout is rebuilt here as it was: each plane allocated on its own, keyed
+ * by its ID, with its instance data allocated separately again.
+ *
+ * Two things are timed on each layout:
+ * - a client update: looking every plane up by ID and copying in its new
+ *   position, surfaces and surveillance.
+ * - a per-frame pass: the same small kernel (convert to local coordinates,
+ *   work out the distance, write it back) run over every plane.
+ * The real frame - a client update plus Render_PrepLists - is timed on the
+ * PlaneStore as well, for scale.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <XPLMGraphics.h>
+
+#include "BenchSupport.h"
+#include "CSL.h"
+#include "PlaneType.h"
+#include "Renderer.h"
+#include "XPMPMultiplayer.h"
+#include "XPMPMultiplayerVars.h"
+
+// LegacyInstanceData and LegacyPlane have the layout of CSLInstanceData and
+// XPMPPlane before the PlaneStore.
+class LegacyInstanceData {
+public:
+	virtual ~LegacyInstanceData() = default;
+
+	float	mDistanceSqr = 0.0f;
+	bool	mTCAS = false;
+	bool	mCulled = false;
+	bool	mClamped = false;
+};
+
+class LegacyPlane {
+public:
+	virtual ~LegacyPlane() = default;
+
+	PlaneType				mPlaneType;
+	XPMPPlanePosition_t		mPosition = {};
+	XPMPPlaneSurfaces_t		mSurface = {};
+	XPMPPlaneSurveillance_t	mSurveillance = {};
+	CSL *					mCSL = nullptr;
+	int						mMatchQuality = -1;
+	std::unique_ptr<LegacyInstanceData>	mInstanceData;
+};
+
+typedef std::unordered_map<void *, std::unique_ptr<LegacyPlane>>	LegacyPlaneMap;
+
+static const int	kPlaneCounts[] = {100, 1000, 5000};
+static const char *const	kTypes[] = {"B738", "A320", "C208", "B744", "MD11"};
+
+static void
+LegacyUpdatePlanes(LegacyPlaneMap &planes, const std::vector<XPMPUpdate_t> &updates)
+{
+	for (const auto &update: updates) {
+		auto iter = planes.find(update.plane);
+		if (iter == planes.end()) {
+			continue;
+		}
+		LegacyPlane &plane = *iter->second;
+		memcpy(&plane.mPosition, update.position, std::min(update.position->size, sizeof(plane.mPosition)));
+		memcpy(&plane.mSurface, update.surfaces, std::min(update.surfaces->size, sizeof(plane.mSurface)));
+		memcpy(&plane.mSurveillance, update.surveillance, std::min(update.surveillance->size, sizeof(plane.mSurveillance)));
+	}
+}
+
+/** LocalDistanceSqr is the per-frame kernel both layouts run. */
+static float
+LocalDistanceSqr(const XPMPPlanePosition_t &position)
+{
+	double x, y, z;
+	XPLMWorldToLocal(position.lat, position.lon, position.elevation * kFtToMeters, &x, &y, &z);
+	return static_cast<float>(x * x + y * y + z * z);
+}
+
+int
+main()
+{
+	const std::string root = Bench_TempDir("xpmp_store_bench");
+	const SyntheticLibrary library = Bench_WriteLibrary(root, 4, 50);
+	XPMPMultiplayerInit(nullptr, library.relatedPath.c_str(), library.doc8643Path.c_str());
+	XPMPLoadCSLPackages(library.cslPath.c_str());
+	Bench_SetView(0.0f, 60.0f, 16.0f / 9.0f, 1.0f, 50000.0f);
+
+	const int kReps = 50;
+	printf("%6s | %11s %11s | %11s %11s | %11s\n",
+		"", "update us", "", "pass us", "", "frame us");
+	printf("%6s | %11s %11s | %11s %11s | %11s\n",
+		"planes", "map", "store", "map", "store", "store");
+	for (const int count: kPlaneCounts) {
+		std::vector<XPMPPlanePosition_t> positions(count);
+		std::vector<XPMPPlaneSurfaces_t> surfaces(count);
+		std::vector<XPMPPlaneSurveillance_t> surveillance(count);
+		for (int i = 0; i < count; ++i) {
+			positions[i] = {};
+			positions[i].size = sizeof(positions[i]);
+			positions[i].lat = 0.001 * (i % 100);
+			positions[i].lon = 0.001 * (i / 100);
+			positions[i].elevation = 1000.0;
+			surfaces[i] = {};
+			surfaces[i].size = sizeof(surfaces[i]);
+			surveillance[i] = {};
+			surveillance[i].size = sizeof(surveillance[i]);
+			surveillance[i].mode = xpmpTransponderMode_ModeC;
+		}
+
+		// the same planes in both layouts.
+		LegacyPlaneMap legacy;
+		std::vector<XPMPUpdate_t> legacyUpdates(count);
+		std::vector<XPMPUpdate_t> storeUpdates(count);
+		for (int i = 0; i < count; ++i) {
+			auto plane = std::make_unique<LegacyPlane>();
+			plane->mPlaneType = PlaneType(kTypes[i % 5]);
+			plane->mInstanceData = std::make_unique<LegacyInstanceData>();
+			void *id = plane.get();
+			legacy.emplace(id, std::move(plane));
+			legacyUpdates[i] = {id, &positions[i], &surfaces[i], &surveillance[i]};
+			storeUpdates[i] = {XPMPCreatePlane(kTypes[i % 5], "", ""), &positions[i], &surfaces[i], &surveillance[i]};
+		}
+
+		// let the models load before anything's timed.
+		XPMPUpdatePlanes(storeUpdates.data(), sizeof(XPMPUpdate_t), count);
+		Bench_NextFrame();
+		Render_PrepLists();
+		Bench_CompleteLoads();
+
+		const double legacyUpdate = Bench_BestOf(kReps, [&] {
+			LegacyUpdatePlanes(legacy, legacyUpdates);
+		});
+		const double storeUpdate = Bench_BestOf(kReps, [&] {
+			XPMPUpdatePlanes(storeUpdates.data(), sizeof(XPMPUpdate_t), count);
+		});
+
+		const double legacyPass = Bench_BestOf(kReps, [&] {
+			for (auto &planePair: legacy) {
+				LegacyPlane &plane = *planePair.second;
+				plane.mInstanceData->mDistanceSqr = LocalDistanceSqr(plane.mPosition);
+			}
+		});
+		std::vector<float> distanceSqr(count);
+		const double storePass = Bench_BestOf(kReps, [&] {
+			for (size_t i = 0; i < gPlanes.size(); ++i) {
+				distanceSqr[i] = LocalDistanceSqr(gPlanes.position(i));
+			}
+		});
+
+		const double frame = Bench_BestOf(kReps, [&] {
+			XPMPUpdatePlanes(storeUpdates.data(), sizeof(XPMPUpdate_t), count);
+			Bench_NextFrame();
+			Render_PrepLists();
+		});
+
+		printf("%6d | %11.1f %11.1f | %11.1f %11.1f | %11.1f\n",
+			count, legacyUpdate, storeUpdate, legacyPass, storePass, frame);
+
+		for (const auto &update: storeUpdates) {
+			XPMPDestroyPlane(update.plane);
+		}
+	}
+
+	XPMPMultiplayerCleanup();
+	Bench_RemoveDir(root);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/*
+ * TokenizeBench
+ *
+ * Compares the two xpmp::tokenize overloads: the original one, which
+ * returns a copy of each token, and the one that returns views into the
+ * line.  Both split every line of an xsb_aircraft.txt, with and without a
+ * token limit, and must produce the same tokens.  A line with a few hundred
+ * tokens is timed too, as that's where copying the rest of the line for
+ * every token shows.
+ *
+ * Usage: TokenizeBench [xsb_aircraft.txt]
+ *
+ * Without a file, a package from the generated library is used.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "XStringUtils.h"
+
+static const char	kDelimiters[] = " \t\r\n";
+static const int	kReps = 20;
+
+// the token counts go here, so the timed loops can't be optimised away.
+static volatile size_t	gSink;
+
+struct TokenizeResult {
+	double	copyTime;
+	double	viewTime;
+	size_t	tokens;
+	size_t	mismatches;
+};
+
+static TokenizeResult
+CompareTokenizers(const std::vector<std::string> &lines, int limit, int passes)
+{
+	TokenizeResult result = {};
+	std::vector<std::string_view> views;
+	for (const auto &line: lines) {
+		const std::vector<std::string> copies = xpmp::tokenize(line, kDelimiters, limit);
+		xpmp::tokenize(line, kDelimiters, views, limit);
+		if (copies.size() != views.size()) {
+			++result.mismatches;
+			continue;
+		}
+		for (size_t n = 0; n < copies.size(); ++n) {
+			if (copies[n] != views[n]) {
+				++result.mismatches;
+				break;
+			}
+		}
+		result.tokens += views.size();
+	}
+
+	result.copyTime = Bench_BestOf(kReps, [&] {
+		for (int pass = 0; pass < passes; ++pass) {
+			for (const auto &line: lines) {
+				gSink += xpmp::tokenize(line, kDelimiters, limit).size();
+			}
+		}
+	});
+	result.viewTime = Bench_BestOf(kReps, [&] {
+		for (int pass = 0; pass < passes; ++pass) {
+			for (const auto &line: lines) {
+				xpmp::tokenize(line, kDelimiters, views, limit);
+				gSink += views.size();
+			}
+		}
+	});
+	return result;
+}
+
+int
+main(int argc, char **argv)
+{
+	std::string root;
+	std::string path;
+	if (argc > 1) {
+		path = argv[1];
+	} else {
+		root = Bench_TempDir("xpmp_tokenize_bench");
+		const SyntheticLibrary library = Bench_WriteLibrary(root, 2, 500);
+		path = library.cslPath + "/PKG000/xsb_aircraft.txt";
+	}
+
+	std::ifstream in(path);
+	if (!in) {
+		fprintf(stderr, "couldn't read %s\n", path.c_str());
+		return EXIT_FAILURE;
+	}
+	std::vector<std::string> lines;
+	for (std::string line; std::getline(in, line);) {
+		lines.push_back(line);
+	}
+
+	std::string longLine("LIVERY");
+	for (int n = 0; n < 300; ++n) {
+		longLine += " TOKEN" + std::to_string(n);
+	}
+	const std::vector<std::string> longLines(1, longLine);
+
+	printf("%zu lines from %s, best of %d\n", lines.size(), path.c_str(), kReps);
+	printf("%-18s %8s %10s %10s %8s %11s\n", "", "tokens", "copy us", "view us", "speedup", "mismatches");
+	struct {
+		const char *						name;
+		const std::vector<std::string> &	lines;
+		int									limit;
+		int									passes;
+	} const cases[] = {
+		{ "file", lines, 0, 1 },
+		{ "file, limit 2", lines, 2, 1 },
+		{ "300 token line", longLines, 0, 100 },
+	};
+	size_t mismatches = 0;
+	for (const auto &test: cases) {
+		const TokenizeResult result = CompareTokenizers(test.lines, test.limit, test.passes);
+		printf("%-18s %8zu %10.1f %10.1f %7.1fx %11zu\n", test.name, result.tokens, result.copyTime, result.viewTime,
+			result.copyTime / result.viewTime, result.mismatches);
+		mismatches += result.mismatches;
+	}
+
+	if (!root.empty()) {
+		Bench_RemoveDir(root);
+	}
+	return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
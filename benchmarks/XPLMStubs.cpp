@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/*
+ * XPLMStubs
+ *
+ * Stand-ins for the XPLM functions the library calls, so the benchmarks can
+ * run outside of X-Plane.  They do as little as they can while still giving
+ * the library something sensible to work with: datarefs hold whatever the
+ * benchmark puts in them, object loads complete when the benchmark says
+ * so, and instances are just counted.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <XPLMCamera.h>
+#include <XPLMDataAccess.h>
+#include <XPLMDisplay.h>
+#include <XPLMGraphics.h>
+#include <XPLMInstance.h>
+#include <XPLMMap.h>
+#include <XPLMPlanes.h>
+#include <XPLMPlugin.h>
+#include <XPLMProcessing.h>
+#include <XPLMScenery.h>
+#include <XPLMUtilities.h>
+
+#include "BenchSupport.h"
+
+// the sim only has so many multiplayer datarefs, and TCAS looks for them
+// until one's missing.
+static const int	kMultiplayerPlanes = 19;
+
+struct StubDataRef {
+	int		i = 0;
+	float	f = 0.0f;
+	double	d = 0.0;
+	float	v[16] = {};
+};
+
+static std::map<std::string, StubDataRef>	gDataRefs;
+static bool		gLogging = false;
+static int		gCycle = 0;
+static float	gElapsed = 0.0f;
+static std::vector<std::pair<XPLMObjectLoaded_f, void *>>	gPendingLoads;
+
+static StubDataRef &
+DataRef(const char *name)
+{
+	return gDataRefs[name];
+}
+
+void
+Bench_SetLogging(bool enabled)
+{
+	gLogging = enabled;
+}
+
+void
+Bench_SetView(float yaw, float fovY, float aspect, float nearClip, float farClip)
+{
+	// an OpenGL style perspective projection, and a modelview that only
+	// turns the camera, both column major like the sim's.
+	const float f = 1.0f / std::tan(fovY * static_cast<float>(M_PI) / 360.0f);
+	float *proj = DataRef("sim/graphics/view/projection_matrix").v;
+	std::fill(proj, proj + 16, 0.0f);
+	proj[0] = f / aspect;
+	proj[5] = f;
+	proj[10] = (farClip + nearClip) / (nearClip - farClip);
+	proj[11] = -1.0f;
+	proj[14] = 2.0f * farClip * nearClip / (nearClip - farClip);
+
+	const float c = std::cos(yaw * static_cast<float>(M_PI) / 180.0f);
+	const float s = std::sin(yaw * static_cast<float>(M_PI) / 180.0f);
+	float *modelView = DataRef("sim/graphics/view/modelview_matrix").v;
+	std::fill(modelView, modelView + 16, 0.0f);
+	modelView[0] = c;
+	modelView[2] = -s;
+	modelView[5] = 1.0f;
+	modelView[8] = s;
+	modelView[10] = c;
+	modelView[15] = 1.0f;
+
+	DataRef("sim/graphics/view/visibility_effective_m").f = 40000.0f;
+}
+
+void
+Bench_NextFrame()
+{
+	++gCycle;
+	gElapsed += 1.0f / 60.0f;
+}
+
+void
+Bench_CompleteLoads()
+{
+	// a callback may queue the next load, so work from a copy.
+	auto loads = std::move(gPendingLoads);
+	gPendingLoads.clear();
+	for (auto &load: loads) {
+		load.first(reinterpret_cast<XPLMObjectRef>(1), load.second);
+	}
+}
+
+extern "C" {
+
+void
+XPLMDebugString(const char *inString)
+{
+	if (gLogging) {
+		fputs(inString, stderr);
+	}
+}
+
+void
+XPLMGetSystemPath(char *outSystemPath)
+{
+	strcpy(outSystemPath, Bench_SystemPath().c_str());
+}
+
+const char *
+XPLMGetDirectorySeparator(void)
+{
+	return "/";
+}
+
+int
+XPLMGetDirectoryContents(
+	const char *inDirectoryPath,
+	int inFirstReturn,
+	char *outFileNames,
+	int inFileNameBufSize,
+	char **outIndices,
+	int inIndexCount,
+	int *outTotalFiles,
+	int *outReturnedFiles)
+{
+	std::vector<std::string> names;
+	std::error_code error;
+	for (const auto &entry: std::filesystem::directory_iterator(inDirectoryPath, error)) {
+		names.push_back(entry.path().filename().string());
+	}
+	std::sort(names.begin(), names.end());
+
+	int returned = 0;
+	char *next = outFileNames;
+	for (size_t n = static_cast<size_t>(std::max(inFirstReturn, 0)); n < names.size() && returned < inIndexCount; ++n) {
+		const size_t len = names[n].size() + 1;
+		if (next + len > outFileNames + inFileNameBufSize) {
+			break;
+		}
+		memcpy(next, names[n].c_str(), len);
+		outIndices[returned++] = next;
+		next += len;
+	}
+	if (outTotalFiles) {
+		*outTotalFiles = static_cast<int>(names.size());
+	}
+	if (outReturnedFiles) {
+		*outReturnedFiles = returned;
+	}
+	return returned == static_cast<int>(names.size()) - std::max(inFirstReturn, 0);
+}
+
+XPLMPluginID
+XPLMGetMyID(void)
+{
+	return 1;
+}
+
+int
+XPLMIsFeatureEnabled(const char *)
+{
+	return 1;
+}
+
+XPLMDataRef
+XPLMFindDataRef(const char *inDataRefName)
+{
+	static const char		kMultiplayer[] = "sim/multiplayer/position/plane";
+	static const size_t		kMultiplayerLen = sizeof(kMultiplayer) - 1;
+	if (strncmp(inDataRefName, kMultiplayer, kMultiplayerLen) == 0 &&
+		atoi(inDataRefName + kMultiplayerLen) > kMultiplayerPlanes) {
+		return nullptr;
+	}
+	return &DataRef(inDataRefName);
+}
+
+int
+XPLMGetDatai(XPLMDataRef inDataRef)
+{
+	return static_cast<StubDataRef *>(inDataRef)->i;
+}
+
+void
+XPLMSetDatai(XPLMDataRef inDataRef, int inValue)
+{
+	static_cast<StubDataRef *>(inDataRef)->i = inValue;
+}
+
+float
+XPLMGetDataf(XPLMDataRef inDataRef)
+{
+	return static_cast<StubDataRef *>(inDataRef)->f;
+}
+
+void
+XPLMSetDataf(XPLMDataRef inDataRef, float inValue)
+{
+	static_cast<StubDataRef *>(inDataRef)->f = inValue;
+}
+
+double
+XPLMGetDatad(XPLMDataRef inDataRef)
+{
+	return static_cast<StubDataRef *>(inDataRef)->d;
+}
+
+int
+XPLMGetDatavf(XPLMDataRef inDataRef, float *outValues, int inOffset, int inMax)
+{
+	const float *values = static_cast<StubDataRef *>(inDataRef)->v;
+	int count = 0;
+	for (int n = inOffset; n < 16 && count < inMax; ++n) {
+		outValues[count++] = values[n];
+	}
+	return count;
+}
+
+XPLMDataRef
+XPLMRegisterDataAccessor(
+	const char *inDataName,
+	XPLMDataTypeID, int,
+	XPLMGetDatai_f, XPLMSetDatai_f,
+	XPLMGetDataf_f, XPLMSetDataf_f,
+	XPLMGetDatad_f, XPLMSetDatad_f,
+	XPLMGetDatavi_f, XPLMSetDatavi_f,
+	XPLMGetDatavf_f, XPLMSetDatavf_f,
+	XPLMGetDatab_f, XPLMSetDatab_f,
+	void *, void *)
+{
+	return &DataRef(inDataName);
+}
+
+int
+XPLMShareData(const char *, XPLMDataTypeID, XPLMDataChanged_f, void *)
+{
+	return 1;
+}
+
+int
+XPLMRegisterDrawCallback(XPLMDrawCallback_f, XPLMDrawingPhase, int, void *)
+{
+	return 1;
+}
+
+int
+XPLMUnregisterDrawCallback(XPLMDrawCallback_f, XPLMDrawingPhase, int, void *)
+{
+	return 1;
+}
+
+// the local coordinates are a flat projection around 0,0 - near enough for
+// the few kilometres the benchmarks cover.
+static const double	kMetresPerDegree = 111194.9;
+
+void
+XPLMWorldToLocal(double inLatitude, double inLongitude, double inAltitude, double *outX, double *outY, double *outZ)
+{
+	*outX = inLongitude * kMetresPerDegree;
+	*outY = inAltitude;
+	*outZ = -inLatitude * kMetresPerDegree;
+}
+
+void
+XPLMLocalToWorld(double inX, double inY, double inZ, double *outLatitude, double *outLongitude, double *outAltitude)
+{
+	*outLatitude = -inZ / kMetresPerDegree;
+	*outLongitude = inX / kMetresPerDegree;
+	*outAltitude = inY;
+}
+
+float
+XPLMGetElapsedTime(void)
+{
+	return gElapsed;
+}
+
+int
+XPLMGetCycleNumber(void)
+{
+	return gCycle;
+}
+
+void
+XPLMRegisterFlightLoopCallback(XPLMFlightLoop_f, float, void *)
+{
+}
+
+void
+XPLMUnregisterFlightLoopCallback(XPLMFlightLoop_f, void *)
+{
+}
+
+void
+XPLMReadCameraPosition(XPLMCameraPosition_t *outCameraPosition)
+{
+	memset(outCameraPosition, 0, sizeof(*outCameraPosition));
+	outCameraPosition->zoom = 1.0f;
+}
+
+void
+XPLMCountAircraft(int *outTotalAircraft, int *outActiveAircraft, XPLMPluginID *outController)
+{
+	*outTotalAircraft = kMultiplayerPlanes + 1;
+	*outActiveAircraft = 1;
+	*outController = -1;
+}
+
+int
+XPLMAcquirePlanes(char **, XPLMPlanesAvailable_f, void *)
+{
+	return 1;
+}
+
+void
+XPLMReleasePlanes(void)
+{
+}
+
+void
+XPLMSetActiveAircraftCount(int)
+{
+}
+
+XPLMProbeRef
+XPLMCreateProbe(XPLMProbeType)
+{
+	return reinterpret_cast<XPLMProbeRef>(1);
+}
+
+void
+XPLMDestroyProbe(XPLMProbeRef)
+{
+}
+
+XPLMProbeResult
+XPLMProbeTerrainXYZ(XPLMProbeRef, float inX, float, float inZ, XPLMProbeInfo_t *outInfo)
+{
+	outInfo->locationX = inX;
+	outInfo->locationY = 0.0f;
+	outInfo->locationZ = inZ;
+	outInfo->normalX = 0.0f;
+	outInfo->normalY = 1.0f;
+	outInfo->normalZ = 0.0f;
+	return xplm_ProbeHitTerrain;
+}
+
+XPLMObjectRef
+XPLMLoadObject(const char *)
+{
+	return reinterpret_cast<XPLMObjectRef>(1);
+}
+
+void
+XPLMLoadObjectAsync(const char *, XPLMObjectLoaded_f inCallback, void *inRefcon)
+{
+	gPendingLoads.emplace_back(inCallback, inRefcon);
+}
+
+void
+XPLMUnloadObject(XPLMObjectRef)
+{
+}
+
+XPLMInstanceRef
+XPLMCreateInstance(XPLMObjectRef, const char **)
+{
+	return new char;
+}
+
+void
+XPLMDestroyInstance(XPLMInstanceRef instance)
+{
+	delete static_cast<char *>(instance);
+}
+
+void
+XPLMInstanceSetPosition(XPLMInstanceRef, const XPLMDrawInfo_t *, const float *)
+{
+}
+
+XPLMMapLayerID
+XPLMCreateMapLayer(XPLMCreateMapLayer_t *)
+{
+	return nullptr;
+}
+
+int
+XPLMDestroyMapLayer(XPLMMapLayerID)
+{
+	return 1;
+}
+
+void
+XPLMRegisterMapCreationHook(XPLMMapCreatedCallback_f, void *)
+{
+}
+
+int
+XPLMMapExists(const char *)
+{
+	return 0;
+}
+
+void
+XPLMDrawMapIconFromSheet(XPLMMapLayerID, const char *, int, int, int, int, float, float, XPLMMapOrientation, float, float)
+{
+}
+
+void
+XPLMDrawMapLabel(XPLMMapLayerID, const char *, float, float, XPLMMapOrientation, float)
+{
+}
+
+void
+XPLMMapProject(XPLMMapProjectionID, double, double, float *, float *)
+{
+}
+
+float
+XPLMMapGetNorthHeading(XPLMMapProjectionID, float, float)
+{
+	return 0.0f;
+}
+
+}
@@ -93,11 +93,30 @@ extern "C" {
  * with it's actual use.
  */
 typedef struct XPMPConfiguration_s {
-	float					maxFullAircraftRenderingDistance;	/// Beyond what distance do we start using lights-only rendering?
+	float					maxFullAircraftRenderingDistance;	/// Beyond what distance (in km) do we start using lower detail rendering?
 	bool 					enableSurfaceClamping;		/// do we clamp all aircraft to the surface?
 	struct {
 		bool modelMatching;								/// Enable Verbose Debugging about Model matching
 	} debug;
+	int						loaderThreads;				/// how many threads parse CSL packages, or 0 for one per processor
+	struct {
+		float	frameBudget;		/// time (in microseconds) per frame for refreshing planes beyond nearDistance, or 0 for no limit
+		float	nearDistance;		/// visible planes within this distance (in metres) are refreshed every frame, or all of them if 0
+		float	farDistance;		/// visible planes within this distance are refreshed every 2nd frame, and beyond it every 4th, or all of them every 2nd if 0
+		int		culledInterval;		/// how often (in frames) planes that can't be seen are refreshed
+	} scheduler;
+	int						instancePoolSize;			/// how many unused instances of each object to keep for re-use
+	int						maxConcurrentLoads;			/// how many objects may be loading at once
+	struct {
+		float	lowDetailDistance;		/// between maxFullAircraftRenderingDistance and this (in km) planes use LOW_LOD + LIGHTS, and beyond it LIGHTS only
+		float	hysteresis;				/// how far (as a fraction of the distance) a plane must cross a band's edge before its level of detail changes
+		float	referenceFieldOfView;	/// the vertical field of view (in degrees) the distances are for; zooming in pushes them out.  0 disables this.
+	} lod;
+	struct {
+		bool	suppress;			/// stop refreshing planes that stay out of view, and park their instances out of sight until they come back
+		float	guardBand;			/// how far (in metres) beyond its bounds a plane is still treated as in view, which also covers the view being read a frame before it is drawn
+		int		parkAfterFrames;	/// how many frames a plane must be out of view before its instances are parked; until then it's refreshed as if suppress were off
+	} offscreen;
 } XPMPConfiguration_t;
 
 
@@ -134,6 +153,8 @@ void XPMPGetConfiguration(XPMPConfiguration_t *outConfig);
  *
  * Note that there is no notion of aircraft velocity or acceleration; you will be queried for
  * your position every rendering frame.  Higher level APIs can use velocity and acceleration.
+ * Alternatively, XPMPSetPlaneFix hands the motion of a plane over to the built-in motion
+ * engine, which extrapolates it from occasional fixes.
  *
  */
 typedef	struct {
@@ -150,6 +171,92 @@ typedef	struct {
 } XPMPPlanePosition_t;
 
 
+/**
+ * XPMPPlaneFix_t is a timestamped fix of an aircraft's position and motion for the built-in
+ * motion engine.
+ *
+ * The position and attitude fields have the same meanings as in XPMPPlanePosition_t.  Velocities
+ * are in metres per second along true north, east and up, and the rates are in degrees per
+ * second.
+ *
+ */
+typedef struct {
+	size_t	size;
+	double	age;				// seconds since the fix was taken
+	double	lat;
+	double	lon;
+	double	elevation;
+	float	pitch;
+	float	roll;
+	float	heading;
+	float	velocityNorth;
+	float	velocityEast;
+	float	velocityUp;
+	float	pitchRate;
+	float	rollRate;
+	float	headingRate;
+} XPMPPlaneFix_t;
+
+/**
+ * XPMPTerrainProbeStats_t reports how much terrain probing surface clamping is doing.
+ *
+ * Lookups count every time a clamped plane needed the terrain height under it, and probes count
+ * the lookups that couldn't be answered from the cache and went to the sim.
+ */
+typedef struct {
+	size_t	size;
+	long	probes;				// terrain probes since the library was initialised
+	long	lookups;			// terrain height lookups since the library was initialised
+	long	lastFrameProbes;	// terrain probes in the last frame
+	long	lastFrameLookups;	// terrain height lookups in the last frame
+} XPMPTerrainProbeStats_t;
+
+/**
+ * XPMPInstanceUpdateStats_t reports how many instance updates are being sent to the sim.
+ *
+ * Each instance a plane is refreshed with counts once: as pushed if its position, control
+ * surfaces or lights had changed since the last push, or as skipped if they hadn't.
+ */
+typedef struct {
+	size_t	size;
+	long	pushed;				// instance updates sent since the library was initialised
+	long	skipped;			// unchanged instance updates skipped since the library was initialised
+	long	lastFramePushed;	// instance updates sent in the last frame
+	long	lastFrameSkipped;	// unchanged instance updates skipped in the last frame
+} XPMPInstanceUpdateStats_t;
+
+/**
+ * XPMPInstancePoolStats_t reports how well the instance pool is saving instance creation.
+ *
+ * Instances that are no longer needed (after a level of detail change, or when their plane is
+ * destroyed) are parked in their object's pool, up to instancePoolSize of them, and handed out
+ * again instead of creating new ones.
+ */
+typedef struct {
+	size_t	size;
+	long	created;			// instances created since the library was initialised
+	long	destroyed;			// instances destroyed since the library was initialised
+	long	reused;				// instances handed out again from a pool
+	long	pooled;				// instances currently parked in pools
+} XPMPInstancePoolStats_t;
+
+/**
+ * XPMPObjectLoadStats_t reports how the asynchronous object loads are keeping up.
+ *
+ * Latency is the time from an object being needed to it being ready, including any time spent
+ * queued waiting for a free load slot (see maxConcurrentLoads).  Load time is just the time the
+ * sim took.
+ */
+typedef struct {
+	size_t	size;
+	long	queued;				// loads waiting for a free slot
+	long	inFlight;			// loads the sim is working on
+	long	completed;			// loads finished (including failures) since the library was initialised
+	long	failed;				// loads the sim couldn't complete since the library was initialised
+	float	averageLatency;		// average latency (in seconds) of the completed loads
+	float	averageLoadTime;	// average load time (in seconds) of the completed loads
+} XPMPObjectLoadStats_t;
+
 /** The XPMPLightStatus enum defines the settings for the lights bitfield in XPMPPlaneSurfaces_t
  *
  * The upper 16 bit of the light code (timeOffset) should be initialized only once
@@ -235,6 +342,15 @@ typedef	struct {
  */
 typedef	void *		XPMPPlaneID;
 
+/** XPMPPlaneType_t is an ICAO/Airline/Livery triplet for XPMPCreatePlanes.
+ * The airline and livery may be NULL as a shorthand for the empty string.
+ */
+typedef struct {
+	const char *			icao;
+	const char *			airline;
+	const char *			livery;
+} XPMPPlaneType_t;
+
 /** XPMPPlaneUpdate is used to feed updates in aircraft state data into libxplanemp
  */
 typedef struct {
@@ -361,7 +477,8 @@ void XPMPGetModelInfo(int inIndex, const char **outModelName, const char **outIc
  * @param inICAOCode ICAO code for the new aircraft
  * @param inAirline Airline code for the new aircraft
  * @param inLivery Livery code for the new aircraft
- * @return an opaque ID for the plane
+ * @return an opaque ID for the plane, or NULL if the plane limit has been
+ * 		reached
  */
 XPMPPlaneID	XPMPCreatePlane(
 		const char *			inICAOCode,
@@ -386,7 +503,8 @@ XPMPPlaneID	XPMPCreatePlane(
  * @param inICAOCode ICAO code for the new aircraft
  * @param inAirline Airline code for the new aircraft
  * @param inLivery Livery code for the new aircraft
- * @return an opaque ID for the plane
+ * @return an opaque ID for the plane, or NULL if the plane limit has been
+ * 		reached
  */
 XPMPPlaneID	XPMPCreatePlaneWithModelName(
 		const char *			inModelName,
@@ -394,7 +512,31 @@ XPMPPlaneID	XPMPCreatePlaneWithModelName(
 		const char *			inAirline,
 		const char *			inLivery);
 
+/** XPMPCreatePlanes creates a batch of new planes at once, each with a model
+ * and livery assigned based on its ICAO/Airline/Livery triplet.
+ *
+ * This is equivalent to calling XPMPCreatePlane for each type in turn, but
+ * the plane storage is only grown once for the whole batch, which makes it
+ * cheaper when joining a busy network session.  Each distinct type is only
+ * matched once, as repeats are answered from the match cache.
+ *
+ * @param inTypes array of inCount types for the new aircraft.  A type with
+ * 		a NULL icao is skipped.
+ * @param inCount number of planes to create
+ * @param outIDs array of inCount IDs which receives the opaque IDs for the
+ * 		new planes, in the same order as inTypes.  IDs are NULL for any planes
+ * 		that were skipped, or couldn't be created as the plane limit was
+ * 		reached.
+ */
+void			XPMPCreatePlanes(
+		const XPMPPlaneType_t *	inTypes,
+		int						inCount,
+		XPMPPlaneID *			outIDs);
+
 /** XPMPDestroyPlane deallocates a created aircraft.
+ *
+ * IDs of destroyed planes are recognised as stale, so destroying a plane
+ * twice is harmless, as is updating a plane after it's been destroyed.
  *
  * @param inID the plane to destroy
  */
@@ -448,6 +590,80 @@ void		XPMPUpdatePlanes(
 	size_t						inUpdateSize,
 	size_t						inCount);
 
+/** XPMPQueuePlaneUpdates queues a bulk update on a number of aircraft
+ * positions or states, to be applied at the start of the next frame.
+ *
+ * Unlike XPMPUpdatePlanes, this may be called from any thread, at any rate,
+ * and never blocks.  The updates and the structures they point to are
+ * copied, so the caller's buffers can be reused as soon as it returns.
+ *
+ * If a plane is updated more than once before the next frame, only the
+ * newest position, surfaces and surveillance state for it are applied.
+ * Updates for planes destroyed in the meantime are discarded.
+ *
+ * @note queued updates are applied after any XPMPUpdatePlanes calls made
+ * 		during the frame, so don't update the same plane both ways.
+ *
+ * @param inUpdates a pointer to the first element of an array of XPMPUpdate_t
+ * @param inUpdateSize the size of a single XPMPUpdate_t structure
+ * @param inCount the total count of elements to process.
+ */
+void		XPMPQueuePlaneUpdates(
+		const XPMPUpdate_t *	inUpdates,
+		size_t					inUpdateSize,
+		size_t					inCount);
+
+/** XPMPSetPlaneFix hands the plane's motion to the built-in motion engine.
+ *
+ * Every frame, the engine extrapolates the plane's latitude, longitude,
+ * elevation and attitude from the most recent fix, so the client no longer
+ * needs to update the position each frame.  When a new fix disagrees with
+ * where the plane was being drawn, the difference is blended out over a
+ * second rather than the plane jumping.
+ *
+ * The other fields of the plane's position (label, offset scale and ground
+ * clamping) are left alone.  Updating the position through
+ * XPMPUpdatePlanes or XPMPQueuePlaneUpdates takes the plane back out of the
+ * engine.
+ *
+ * @param inPlane the plane to update
+ * @param inFix the plane's new fix
+ */
+void		XPMPSetPlaneFix(
+		XPMPPlaneID				inPlane,
+		const XPMPPlaneFix_t *	inFix);
+
+/** XPMPGetTerrainProbeStats reports the surface clamping terrain probe
+ * counters.
+ *
+ * @param outStats receives the counters.  Its size must be set by the caller.
+ */
+void		XPMPGetTerrainProbeStats(
+		XPMPTerrainProbeStats_t *	outStats);
+
+/** XPMPGetInstanceUpdateStats reports the counters of instance updates
+ * pushed to the sim and skipped because nothing had changed.
+ *
+ * @param outStats receives the counters.  Its size must be set by the caller.
+ */
+void		XPMPGetInstanceUpdateStats(
+		XPMPInstanceUpdateStats_t *	outStats);
+
+/** XPMPGetInstancePoolStats reports the instance pool counters.
+ *
+ * @param outStats receives the counters.  Its size must be set by the caller.
+ */
+void		XPMPGetInstancePoolStats(
+		XPMPInstancePoolStats_t *	outStats);
+
+/** XPMPGetObjectLoadStats reports the object load queue's depth and
+ * latency.
+ *
+ * @param outStats receives the counters.  Its size must be set by the caller.
+ */
+void		XPMPGetObjectLoadStats(
+		XPMPObjectLoadStats_t *	outStats);
+
 /** XPMPIsICAOValid searches the models loaded to see if
  *
  * This functions searches through our global vector of valid ICAO codes and returns true if there
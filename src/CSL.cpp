@@ -36,6 +36,9 @@ using namespace std;
 
 CSL::CSL()
 {
+	mICAO = kNoAtom;
+	mAirline = kNoAtom;
+	mLivery = kNoAtom;
 	mOffsetSource = VerticalOffsetSource::None;
 	mMovingGear = true;
 }
@@ -43,6 +46,9 @@ CSL::CSL()
 CSL::CSL(std::vector<std::string> dirNames) :
 	mDirNames(std::move(dirNames))
 {
+	mICAO = kNoAtom;
+	mAirline = kNoAtom;
+	mLivery = kNoAtom;
 	mMovingGear = true;
 	mOffsetSource = VerticalOffsetSource::None;
 }
@@ -96,6 +102,12 @@ CSL::setVerticalOffset(VerticalOffsetSource src, double offset)
 	}
 }
 
+float
+CSL::getBoundingRadius() const
+{
+	return kDefaultBoundingRadius;
+}
+
 void
 CSL::setMovingGear(bool movingGear)
 {
@@ -109,38 +121,38 @@ CSL::getMovingGear() const
 }
 
 void
-CSL::setICAO(std::string icaoCode)
+CSL::setICAO(Atom icaoCode)
 {
 	mICAO = icaoCode;
 }
 
 void
-CSL::setAirline(std::string icaoCode, std::string airline)
+CSL::setAirline(Atom icaoCode, Atom airline)
 {
 	setICAO(icaoCode);
 	mAirline = airline;
 }
 
 void
-CSL::setLivery(std::string icaoCode, std::string airline, std::string livery)
+CSL::setLivery(Atom icaoCode, Atom airline, Atom livery)
 {
 	setAirline(icaoCode, airline);
 	mLivery = livery;
 }
 
-std::string
+const std::string &
 CSL::getICAO() const {
-	return mICAO;
+	return Atom_String(mICAO);
 }
 
-std::string
+const std::string &
 CSL::getAirline() const {
-	return mAirline;
+	return Atom_String(mAirline);
 }
 
-std::string
+const std::string &
 CSL::getLivery() const {
-	return mLivery;
+	return Atom_String(mLivery);
 }
 
 bool
@@ -153,25 +165,20 @@ CSL::drawPlane(CSLInstanceData *instanceData, bool is_blend, int data) const
 {
 }
 
-void
-CSL::updateInstance(const CullInfo &cullInfo,
-                    double &x,
-                    double &y,
-                    double &z,
-                    double roll,
-                    double heading,
-                    double pitch,
-                    bool clampToSurface,
-                    float offsetScale,
-                    xpmp_LightStatus lights,
-                    CSLInstanceData *&instanceData,
-                    XPLMPlaneDrawState_t *state)
+bool
+CSL::placeInstance(double &x,
+                   double &y,
+                   double &z,
+                   TerrainCache *terrain,
+                   size_t terrainIndex,
+                   float offsetScale,
+                   CSLInstanceData *&instanceData)
 {
 	if (instanceData == nullptr) {
 		newInstanceData(instanceData);
 	}
 	if (instanceData == nullptr) {
-		return;
+		return false;
 	}
 
 	double appliedOffset = 0.0;
@@ -181,13 +188,10 @@ CSL::updateInstance(const CullInfo &cullInfo,
 	}
 
 	// clamp to the surface if enabled
-	if (gConfiguration.enableSurfaceClamping && clampToSurface) {
-		XPLMProbeInfo_t	probeResult = {
-			sizeof(XPLMProbeInfo_t),
-		};
-		XPLMProbeResult r = XPLMProbeTerrainXYZ(gTerrainProbe, x, y, z, &probeResult);
-		if (r == xplm_ProbeHitTerrain) {
-			float minY = probeResult.locationY + getVertOffset();
+	if (terrain != nullptr) {
+		double terrainY;
+		if (terrain->heightAt(terrainIndex, x, y, z, terrainY)) {
+			float minY = terrainY + getVertOffset();
 			if (y < minY) {
 				y = minY;
 				instanceData->mClamped = true;
@@ -198,8 +202,15 @@ CSL::updateInstance(const CullInfo &cullInfo,
 	} else {
 	    instanceData->mClamped = false;
 	}
+	return true;
+}
 
-	instanceData->mDistanceSqr = cullInfo.SphereDistanceSqr(x, y, z);
+void
+CSL::updateInstanceState(const FrameContext &frame,
+                         float distanceSqr,
+                         CSLInstanceData *instanceData)
+{
+	instanceData->mDistanceSqr = distanceSqr;
 
 	// TCAS checks.
 	instanceData->mTCAS = true;
@@ -211,11 +222,28 @@ CSL::updateInstance(const CullInfo &cullInfo,
 	// we need to assess cull state so we can work out if we need to render labels or not
 	instanceData->mCulled = false;
 	// cull if the aircraft is not visible due to poor horizontal visibility
-	if (gVisDataRef) {
-		float horizVis = XPLMGetDataf(gVisDataRef);
-		if (instanceData->mDistanceSqr > horizVis*horizVis) {
-			instanceData->mCulled = true;
-		}
+	if (instanceData->mDistanceSqr > frame.visibility*frame.visibility) {
+		instanceData->mCulled = true;
 	}
-	instanceData->updateInstance(this, x, y, z, pitch, roll, heading, lights, state);
+}
+
+void
+CSL::updateInstance(const FrameContext &frame,
+                    double x,
+                    double y,
+                    double z,
+                    double roll,
+                    double heading,
+                    double pitch,
+                    xpmp_LightStatus lights,
+                    CSLInstanceData *instanceData,
+                    XPLMPlaneDrawState_t *state)
+{
+	instanceData->updateInstance(frame, this, x, y, z, pitch, roll, heading, lights, state);
+}
+
+void
+CSL::parkInstance(CSLInstanceData *instanceData)
+{
+	instanceData->parkInstances();
 }
\ No newline at end of file
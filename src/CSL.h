@@ -31,6 +31,9 @@
 #include <XPMPMultiplayer.h>
 
 #include "CullInfo.h"
+#include "FrameContext.h"
+#include "StringAtoms.h"
+#include "TerrainCache.h"
 
 // forward declare XPMPPlane - we can't access it's details, but we can record info.
 class XPMPPlane;
@@ -58,9 +61,16 @@ public:
 protected:
     CSLInstanceData() = default;
 
+    /** the CSL parent class uses this method to hide the instances while
+     * the plane is out of view.  They should be kept rather than destroyed,
+     * as the next updateInstance must bring them back.
+     */
+    virtual void parkInstances() = 0;
+
     /** the CSL parent class uses this method to update the individual
      * instances
      *
+     * @param frame the FrameContext for this frame
      * @param csl the CSL record performing the update
      * @param x X coordinate of the instance (in world units)
      * @param y Y coordinate of the instance (in world units)
@@ -72,6 +82,7 @@ protected:
      * @param state XPLMPlaneDrawState_t containing the aircraft state for this instance
      */
     virtual void updateInstance(
+        const FrameContext &frame,
         CSL *csl,
         double x,
         double y,
@@ -141,6 +152,17 @@ public:
      */
     bool getMovingGear() const;
 
+    /** kDefaultBoundingRadius is the bounding radius (in metres) for models
+     * that don't know their own, which is big enough to cover anything up to
+     * a heavy jet.
+     */
+    static constexpr float kDefaultBoundingRadius = 40.0f;
+
+    /** getBoundingRadius returns the radius (in metres) of a sphere about
+     * the model's origin that contains all of it.
+     */
+    virtual float getBoundingRadius() const;
+
 
     /** isUsable() indicates if the CSL is suitable/available for use.
      *
@@ -153,57 +175,95 @@ public:
      */
     virtual bool isUsable() const;
 
-    void setICAO(std::string icaoCode);
+    void setICAO(Atom icaoCode);
 
-    void setAirline(std::string icaoCode, std::string airline);
+    void setAirline(Atom icaoCode, Atom airline);
 
-    void setLivery(std::string icaoCode,
-                   std::string airline,
-                   std::string livery);
+    void setLivery(Atom icaoCode,
+                   Atom airline,
+                   Atom livery);
 
-    std::string getICAO() const;
+    const std::string &getICAO() const;
 
-    std::string getAirline() const;
+    const std::string &getAirline() const;
 
-    std::string getLivery() const;
+    const std::string &getLivery() const;
 
-    /** updateInstance updates the instanceData for rendering this frame.  If
+    /** placeInstance positions the plane for rendering this frame, applying
+     * the vertical offset and clamping it to the terrain if required.  If
      * the instanceData is not initialised, this method invokes the
      * newInstanceData virtual method to produce it.
      *
-     * @param cullInfo the CullInfo to use to cull objects
      * @param x
      * @param y
-     * @param z
+     * @param z the plane's local position, updated in place.
+     * @param terrain the TerrainCache to clamp with, or nullptr if the plane
+     *     shouldn't be clamped to the surface
+     * @param terrainIndex the plane's entry in the terrain cache
+     * @param offsetScale
+     * @param instanceData the instanceData pointer in the XPMPPlane for this plane
+     * @returns false if there's no instanceData to update.
+     */
+    virtual bool placeInstance(double &x,
+                               double &y,
+                               double &z,
+                               TerrainCache *terrain,
+                               size_t terrainIndex,
+                               float offsetScale,
+                               CSLInstanceData *&instanceData);
+
+    /** updateInstanceState updates the instanceData's distance, TCAS and
+     * cull state for this frame, once it's been placed and culled.
+     *
+     * @param frame the FrameContext for this frame
+     * @param distanceSqr the square of the plane's distance from the camera
+     * @param instanceData the instanceData for this plane
+     */
+    virtual void updateInstanceState(const FrameContext &frame,
+                                     float distanceSqr,
+                                     CSLInstanceData *instanceData);
+
+    /** updateInstance pushes the plane's position and state to its
+     * instances.  It's not necessarily called every frame.
+     *
+     * @param frame the FrameContext for this frame
+     * @param x
+     * @param y
+     * @param z the plane's local position, from placeInstance
      * @param pitch
      * @param roll
      * @param heading
      * @param lights
+     * @param instanceData the instanceData for this plane
      * @param state
-     * @param instanceData the instanceData pointer in the XPMPPlane for this plane
      */
-    virtual void updateInstance(const CullInfo &cullInfo,
-                                double &x,
-                                double &y,
-                                double &z,
+    virtual void updateInstance(const FrameContext &frame,
+                                double x,
+                                double y,
+                                double z,
                                 double roll,
                                 double heading,
                                 double pitch,
-                                bool clampToSurface,
-                                float offsetScale,
                                 xpmp_LightStatus lights,
-                                CSLInstanceData *&instanceData,
+                                CSLInstanceData *instanceData,
                                 XPLMPlaneDrawState_t *state);
 
+    /** parkInstance parks the instanceData's instances while the plane is
+     * out of view, until the next updateInstance.
+     *
+     * @param instanceData the instanceData for this plane
+     */
+    virtual void parkInstance(CSLInstanceData *instanceData);
+
     /* drawPlane is responsible for rendering the plane.
      */
     virtual void drawPlane(CSLInstanceData *instanceData,
                            bool is_blend,
                            int data) const;
 
-    std::string mICAO;          // Icao type of this model
-    std::string mAirline;       // Airline identifier. Can be empty.
-    std::string mLivery;        // Livery identifier. Can be empty.
+    Atom mICAO;          // Icao type of this model
+    Atom mAirline;       // Airline identifier. Can be kNoAtom.
+    Atom mLivery;        // Livery identifier. Can be kNoAtom.
     bool mMovingGear;    // Does gear retract?
     VerticalOffsetSource mOffsetSource;
 
@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#if IBM
+#include <direct.h>
+#endif
+
+#include "CSLIndexCache.h"
+
+using namespace std;
+
+// bump this whenever the record format, or the way the loaders tokenize their
+// files, changes.
+static const char		kCacheMagic[8] = {'X', 'P', 'M', 'P', 'I', 'D', 'X', '\0'};
+static const uint32_t	kCacheVersion = 2;
+
+namespace {
+	// Reader pulls native values out of a buffer, failing (rather than
+	// overrunning) if the buffer is short.
+	class Reader {
+	public:
+		explicit Reader(string_view buffer) :
+			mBuffer(buffer),
+			mOk(true)
+		{
+		}
+
+		template<typename T>
+		T get()
+		{
+			T value{};
+			if (!mOk || mBuffer.size() < sizeof(T)) {
+				mOk = false;
+				return value;
+			}
+			memcpy(&value, mBuffer.data(), sizeof(T));
+			mBuffer.remove_prefix(sizeof(T));
+			return value;
+		}
+
+		string_view getBytes(size_t len)
+		{
+			if (!mOk || mBuffer.size() < len) {
+				mOk = false;
+				return string_view();
+			}
+			auto bytes = mBuffer.substr(0, len);
+			mBuffer.remove_prefix(len);
+			return bytes;
+		}
+
+		bool ok() const
+		{
+			return mOk;
+		}
+
+		bool empty() const
+		{
+			return mBuffer.empty();
+		}
+
+	private:
+		string_view	mBuffer;
+		bool		mOk;
+	};
+
+	template<typename T>
+	void put(string &out, T value)
+	{
+		out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+}
+
+void
+TokenizedFile::addLine(int lineNum, string_view text, const vector<string_view> &lineTokens)
+{
+	lines.emplace_back(Line{lineNum, text, tokens.size(), lineTokens.size()});
+	tokens.insert(tokens.end(), lineTokens.begin(), lineTokens.end());
+}
+
+void
+TokenizedFile::getTokens(const Line &line, vector<string_view> &outTokens) const
+{
+	outTokens.assign(tokens.begin() + line.firstToken, tokens.begin() + line.firstToken + line.tokenCount);
+}
+
+void
+TokenizedFile::clear()
+{
+	lines.clear();
+	lines.shrink_to_fit();
+	tokens.clear();
+	tokens.shrink_to_fit();
+}
+
+/** MakeDirectory creates the directory at path if it doesn't exist. */
+static void
+MakeDirectory(const std::string &path)
+{
+#if IBM
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+std::string
+CSLIndexCache::pathFor(const std::string &systemPath, const char *kind, const std::string &sourceDir)
+{
+	// FNV-1a, so the name is the same from one run (and build) to the next.
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (const char c: sourceDir) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "xpmp_%s_index_%016llx.cache", kind, static_cast<unsigned long long>(hash));
+
+	std::string path = systemPath + "Output";
+	MakeDirectory(path);
+	path += "/caches";
+	MakeDirectory(path);
+	return path + "/" + name;
+}
+
+CSLIndexCache::CSLIndexCache(std::string cachePath) :
+	mCachePath(std::move(cachePath)),
+	mDirty(false)
+{
+	std::ifstream in(mCachePath, std::ios::in | std::ios::binary | std::ios::ate);
+	if (in) {
+		auto size = in.tellg();
+		if (size > 0) {
+			mBuffer.resize(static_cast<size_t>(size));
+			in.seekg(0);
+			in.read(&mBuffer[0], size);
+		}
+	}
+	if (!mBuffer.empty() && !parse()) {
+		// the cache is unusable - start over.
+		mEntries.clear();
+		mBuffer.clear();
+		mDirty = true;
+	}
+}
+
+bool
+CSLIndexCache::parse()
+{
+	Reader in(mBuffer);
+
+	auto magic = in.getBytes(sizeof(kCacheMagic));
+	if (!in.ok() || magic != string_view(kCacheMagic, sizeof(kCacheMagic))) {
+		return false;
+	}
+	if (in.get<uint32_t>() != kCacheVersion) {
+		return false;
+	}
+	auto entryCount = in.get<uint32_t>();
+	for (uint32_t i = 0; in.ok() && i < entryCount; ++i) {
+		auto pathLen = in.get<uint32_t>();
+		auto path = in.getBytes(pathLen);
+		Entry entry;
+		entry.size = in.get<uint64_t>();
+		entry.mtime = in.get<int64_t>();
+		auto recordLen = in.get<uint32_t>();
+		entry.record = in.getBytes(recordLen);
+		entry.used = false;
+		if (in.ok()) {
+			mEntries.emplace(string(path), std::move(entry));
+		}
+	}
+	return in.ok() && in.empty();
+}
+
+bool
+CSLIndexCache::getFileStamp(const std::string &path, uint64_t &outSize, int64_t &outMtime)
+{
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		return false;
+	}
+	outSize = static_cast<uint64_t>(st.st_size);
+	// in nanoseconds, so edits within the same second still show up.
+#if APL
+	outMtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif LIN
+	outMtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#else
+	outMtime = static_cast<int64_t>(st.st_mtime) * 1000000000;
+#endif
+	return true;
+}
+
+bool
+CSLIndexCache::find(const std::string &sourcePath, TokenizedFile &outFile)
+{
+	uint64_t	size;
+	int64_t		mtime;
+	if (!getFileStamp(sourcePath, size, mtime)) {
+		return false;
+	}
+
+	string_view record;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		auto iter = mEntries.find(sourcePath);
+		if (iter == mEntries.end() || iter->second.size != size || iter->second.mtime != mtime) {
+			return false;
+		}
+		iter->second.used = true;
+		record = iter->second.record;
+	}
+
+	// records are immutable once written, so this doesn't need the lock.
+	outFile.clear();
+	Reader in(record);
+	auto lineCount = in.get<uint32_t>();
+	for (uint32_t i = 0; in.ok() && i < lineCount; ++i) {
+		auto lineNum = in.get<int32_t>();
+		auto textLen = in.get<uint32_t>();
+		auto text = in.getBytes(textLen);
+		auto tokenCount = in.get<uint32_t>();
+		outFile.lines.emplace_back(TokenizedFile::Line{lineNum, text, outFile.tokens.size(), tokenCount});
+		for (uint32_t t = 0; in.ok() && t < tokenCount; ++t) {
+			auto offset = in.get<uint32_t>();
+			auto len = in.get<uint32_t>();
+			if (offset > text.size() || len > text.size() - offset) {
+				outFile.clear();
+				return false;
+			}
+			outFile.tokens.emplace_back(text.substr(offset, len));
+		}
+	}
+	if (!in.ok()) {
+		outFile.clear();
+		return false;
+	}
+	return true;
+}
+
+void
+CSLIndexCache::store(const std::string &sourcePath, const TokenizedFile &file)
+{
+	Entry entry;
+	if (!getFileStamp(sourcePath, entry.size, entry.mtime)) {
+		return;
+	}
+
+	put<uint32_t>(entry.ownedRecord, static_cast<uint32_t>(file.lines.size()));
+	for (const auto &line: file.lines) {
+		put<int32_t>(entry.ownedRecord, line.lineNum);
+		put<uint32_t>(entry.ownedRecord, static_cast<uint32_t>(line.text.size()));
+		entry.ownedRecord.append(line.text.data(), line.text.size());
+		put<uint32_t>(entry.ownedRecord, static_cast<uint32_t>(line.tokenCount));
+		for (size_t t = line.firstToken; t < line.firstToken + line.tokenCount; ++t) {
+			// tokens are always views into their line.
+			const auto &token = file.tokens[t];
+			put<uint32_t>(entry.ownedRecord, static_cast<uint32_t>(token.data() - line.text.data()));
+			put<uint32_t>(entry.ownedRecord, static_cast<uint32_t>(token.size()));
+		}
+	}
+	entry.used = true;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto &slot = mEntries[sourcePath];
+	slot = std::move(entry);
+	slot.record = slot.ownedRecord;
+	mDirty = true;
+}
+
+bool
+CSLIndexCache::save()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// entries this run didn't touch may just belong to packages that were
+	// already loaded, so they're only pruned once their file has gone or
+	// changed.
+	for (auto &entryPair: mEntries) {
+		auto &entry = entryPair.second;
+		if (entry.used) {
+			continue;
+		}
+		uint64_t	size;
+		int64_t		mtime;
+		if (getFileStamp(entryPair.first, size, mtime) && size == entry.size && mtime == entry.mtime) {
+			entry.used = true;
+		} else {
+			mDirty = true;
+		}
+	}
+	if (!mDirty) {
+		return true;
+	}
+
+	string out;
+	out.append(kCacheMagic, sizeof(kCacheMagic));
+	put<uint32_t>(out, kCacheVersion);
+	uint32_t entryCount = 0;
+	for (const auto &entryPair: mEntries) {
+		if (entryPair.second.used) {
+			++entryCount;
+		}
+	}
+	put<uint32_t>(out, entryCount);
+	for (const auto &entryPair: mEntries) {
+		const auto &entry = entryPair.second;
+		if (!entry.used) {
+			continue;
+		}
+		put<uint32_t>(out, static_cast<uint32_t>(entryPair.first.size()));
+		out.append(entryPair.first);
+		put<uint64_t>(out, entry.size);
+		put<int64_t>(out, entry.mtime);
+		put<uint32_t>(out, static_cast<uint32_t>(entry.record.size()));
+		out.append(entry.record.data(), entry.record.size());
+	}
+
+	// write the new cache alongside and then swap it in so a failed write
+	// can't leave a truncated cache behind.
+	string tmpPath = mCachePath + ".tmp";
+	{
+		std::ofstream of(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!of) {
+			return false;
+		}
+		of.write(out.data(), static_cast<std::streamsize>(out.size()));
+		if (!of) {
+			of.close();
+			remove(tmpPath.c_str());
+			return false;
+		}
+	}
+	remove(mCachePath.c_str());
+	if (rename(tmpPath.c_str(), mCachePath.c_str()) != 0) {
+		remove(tmpPath.c_str());
+		return false;
+	}
+	mDirty = false;
+	return true;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef CSLINDEXCACHE_H
+#define CSLINDEXCACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** TokenizedFile is a text file that has already been split into lines and
+ * tokens.
+ *
+ * All of the views reference storage owned elsewhere (either the file's
+ * content, or the CSLIndexCache it was found in) which must outlive the
+ * TokenizedFile.
+ */
+struct TokenizedFile {
+	struct Line {
+		int					lineNum;
+		std::string_view	text;
+		size_t				firstToken;
+		size_t				tokenCount;
+	};
+
+	std::vector<Line>				lines;
+	std::vector<std::string_view>	tokens;
+
+	void addLine(int lineNum, std::string_view text, const std::vector<std::string_view> &lineTokens);
+
+	/** getTokens copies the tokens for line into outTokens, reusing its
+	 * storage.
+	 */
+	void getTokens(const Line &line, std::vector<std::string_view> &outTokens) const;
+
+	void clear();
+};
+
+/** CSLIndexCache is an on-disk cache of tokenized text files, used to skip
+ * reading and tokenizing the CSL packages and data files on warm starts.
+ *
+ * Only the tokens are cached.  The packages are still parsed from them, and
+ * the match tables rebuilt, on every load, and that's most of the time a
+ * warm load takes, so a warm load is only somewhat faster than a cold one.
+ *
+ * Each entry is validated against the size and modification time (to the
+ * nanosecond, where the platform's stat has it) of its source file, so any
+ * file that's changed falls back to the text parser individually.
+ *
+ * The cache is only intended to be read by the machine that wrote it, so it's
+ * stored in native byte order.  It's kept in X-Plane's Output/caches folder
+ * rather than next to the files it covers, which may not be writable.
+ */
+class CSLIndexCache {
+public:
+	/** Loads the cache at cachePath if it exists and is valid.  Any problem
+	 * with the file just results in an empty cache.
+	 */
+	explicit CSLIndexCache(std::string cachePath);
+
+	/** pathFor returns the path of the cache for the files in sourceDir.
+	 *
+	 * @param systemPath the X-Plane folder, with a trailing separator
+	 * @param kind what's being cached, to tell the caches for different uses
+	 *     of the same folder apart
+	 * @param sourceDir the folder the cached files are in
+	 * @returns a file in systemPath's Output/caches folder, named after a
+	 *     hash of sourceDir.  The folder is created if required.
+	 */
+	static std::string pathFor(const std::string &systemPath, const char *kind, const std::string &sourceDir);
+
+	CSLIndexCache(const CSLIndexCache &copySrc) = delete;
+	CSLIndexCache &operator=(const CSLIndexCache &copySrc) = delete;
+
+	/** find looks up the tokenized form of sourcePath.
+	 *
+	 * @param sourcePath path to the source text file
+	 * @param outFile TokenizedFile to populate.  It references the cache's
+	 *     storage so must not outlive the cache.
+	 * @returns true if the file was cached and hasn't changed since.
+	 */
+	bool find(const std::string &sourcePath, TokenizedFile &outFile);
+
+	/** store records the tokenized form of sourcePath so the next run can skip
+	 * parsing it.
+	 */
+	void store(const std::string &sourcePath, const TokenizedFile &file);
+
+	/** save writes the cache back to disk if it's changed.  Entries whose
+	 * source file has gone or changed since are dropped.
+	 *
+	 * @returns true if the cache is up to date on disk.
+	 */
+	bool save();
+
+private:
+	struct Entry {
+		uint64_t			size;
+		int64_t				mtime;
+		std::string_view	record;		// the serialised lines
+		std::string			ownedRecord;	// storage for record, if not in mBuffer
+		bool				used;
+	};
+
+	static bool getFileStamp(const std::string &path, uint64_t &outSize, int64_t &outMtime);
+	bool parse();
+
+	std::string		mCachePath;
+	std::string		mBuffer;
+	bool			mDirty;
+	std::mutex		mMutex;
+	std::unordered_map<std::string, Entry>	mEntries;
+};
+
+#endif //CSLINDEXCACHE_H
@@ -23,10 +23,14 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <fstream>
-#include <sstream>
 #include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include <cstdio>
@@ -39,6 +43,8 @@
 
 #include "XPMPMultiplayer.h"
 #include "CSLLibrary.h"
+#include "CSLIndexCache.h"
+#include "StringAtoms.h"
 #include "XStringUtils.h"
 #include "XUtils.h"
 #include "obj8/Obj8CSL.h"
@@ -76,6 +82,91 @@ MakePartialPathNativeObj(string &io_str)
 	}
 }
 
+// ParallelFor runs work(0) ... work(count-1) across a pool of worker threads
+// (gConfiguration.loaderThreads of them, or one per processor) and waits for
+// them all to complete.  If any invocation throws, the first exception is
+// rethrown on the calling thread once the pool has finished.
+static void
+ParallelFor(size_t count, const std::function<void(size_t)> &work)
+{
+	const unsigned int wanted = (gConfiguration.loaderThreads > 0) ?
+		static_cast<unsigned int>(gConfiguration.loaderThreads) : std::thread::hardware_concurrency();
+	size_t threadCount = std::min<size_t>(std::max(wanted, 1U), count);
+	if (threadCount <= 1) {
+		for (size_t i = 0; i < count; ++i) {
+			work(i);
+		}
+		return;
+	}
+
+	std::atomic<size_t>	next(0);
+	std::exception_ptr	failure;
+	std::mutex			failureMutex;
+	auto worker = [&]() {
+		for (size_t i = next++; i < count; i = next++) {
+			try {
+				work(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(failureMutex);
+				if (!failure) {
+					failure = std::current_exception();
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < threadCount; ++t) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (auto &thread: pool) {
+		thread.join();
+	}
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
+}
+
+static Atom
+GroupForICAO(Atom icao)
+{
+	auto iter = gGroupings.find(icao);
+	if (iter == gGroupings.end()) {
+		return kNoAtom;
+	}
+	return iter->second;
+}
+
+/** AddMatch points the key at level to the last plane in the package, unless
+ * an earlier plane has already claimed it.
+ */
+static void
+AddMatch(CSLPackage_t &package, int level, Atom primary, Atom airline = kNoAtom, Atom livery = kNoAtom)
+{
+	package.matches[level].emplace(
+		CSLMatchKey_t{primary, airline, livery},
+		static_cast<int>(package.planes.size()) - 1);
+}
+
+/** MatchKeyString renders key in the old space-separated form for the
+ * diagnostics.
+ */
+static std::string
+MatchKeyString(const CSLMatchKey_t &key)
+{
+	std::string str = Atom_String(key.primary);
+	if (key.airline != kNoAtom) {
+		str += " ";
+		str += Atom_String(key.airline);
+	}
+	if (key.livery != kNoAtom) {
+		str += " ";
+		str += Atom_String(key.livery);
+	}
+	return str;
+}
+
 static bool
 DoPackageSub(std::string &ioPath)
 {
@@ -93,9 +184,16 @@ DoPackageSub(std::string &ioPath)
  * CSL LOADING
  ************************************************************************/
 
+static void CSL_RebuildMatchIndex();
+
+// Packages are parsed on worker threads, so anything the parsers need from
+// the SDK is fetched up front, and anything they share is guarded.
+static std::string	gSystemPath;
+static std::mutex	gAttachmentMutex;
+
 static bool
 ParseExportCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	if (tokens.size() != 2) {
 		XPLMDump(path, lineNum, line) << XPMP_CLIENT_NAME " WARNING: EXPORT_NAME command requires 1 argument.\n";
@@ -103,7 +201,7 @@ ParseExportCommand(
 	}
 
 	auto p = std::find_if(
-		gPackages.begin(), gPackages.end(), [&tokens](CSLPackage_t p) { return p.name == tokens[1]; });
+		gPackages.begin(), gPackages.end(), [&tokens](const CSLPackage_t &p) { return p.name == tokens[1]; });
 	if (p == gPackages.end()) {
 		package.path = path;
 		package.name = tokens[1];
@@ -111,7 +209,7 @@ ParseExportCommand(
 	} else {
 		XPLMDump(path, lineNum, line)
 			<< XPMP_CLIENT_NAME " WARNING: Package name "
-			<< tokens[1].c_str()
+			<< tokens[1]
 			<< " already in use by "
 			<< p->path.c_str()
 			<< " reqested by use by "
@@ -123,18 +221,18 @@ ParseExportCommand(
 
 static bool
 ParseDependencyCommand(
-	const std::vector<std::string> &tokens,
+	const std::vector<std::string_view> &tokens,
 	CSLPackage_t &/*package*/,
 	const string &path,
 	int lineNum,
-	const string &line)
+	std::string_view line)
 {
 	if (tokens.size() != 2) {
 		XPLMDump(path, lineNum, line) << XPMP_CLIENT_NAME " WARNING: DEPENDENCY command needs 1 argument.\n";
 		return false;
 	}
 
-	if (std::count_if(gPackages.begin(), gPackages.end(), [&tokens](CSLPackage_t p) { return p.name == tokens[1]; }) ==
+	if (std::count_if(gPackages.begin(), gPackages.end(), [&tokens](const CSLPackage_t &p) { return p.name == tokens[1]; }) ==
 		0) {
 		XPLMDump(path, lineNum, line)
 			<< XPMP_CLIENT_NAME " WARNING: required package "
@@ -148,7 +246,7 @@ ParseDependencyCommand(
 
 static bool
 ParseAircraftCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	XPLMDump(path, lineNum, line) << XPMP_CLIENT_NAME " ERROR: Encountered legacy AIRCRAFT directive - ACF CSLs are not supported anymore.\n";
 	return false;
@@ -156,7 +254,7 @@ ParseAircraftCommand(
 
 static bool
 ParseObjectCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	XPLMDump(path, lineNum, line) << XPMP_CLIENT_NAME " ERROR: Encountered legacy OBJECT directive - Legacy (OBJ7) CSLs are not supported anymore.\n";
 	return false;
@@ -164,7 +262,7 @@ ParseObjectCommand(
 
 static bool
 ParseTextureCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	XPLMDump(path, lineNum, line) << XPMP_CLIENT_NAME " ERROR: Encountered legacy TEXTURE directive - Legacy (OBJ7) CSLs are not supported anymore.\n";
 	return false;
@@ -172,19 +270,19 @@ ParseTextureCommand(
 
 static bool
 ParseObj8AircraftCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	// OBJ8_AIRCRAFT <path>
 	if (tokens.size() != 2) {
 		XPLMDump(path, lineNum, line) << XPMP_CLIENT_NAME " WARNING: OBJ8_AIRCRAFT command takes 1 argument.\n";
 	}
 
-	auto csl = new Obj8CSL({package.path.substr(package.path.find_last_of('/') + 1)}, tokens[1]);
+	auto csl = new Obj8CSL({package.path.substr(package.path.find_last_of('/') + 1)}, std::string(tokens[1]));
 	package.planes.push_back(csl);
 
 #if DEBUG_CSL_LOADING
 	XPLMDebugString("      Got OBJ8 Airplane: ");
-	XPLMDebugString(tokens[1].c_str());
+	XPLMDebugString(std::string(tokens[1]).c_str());
 	XPLMDebugString("\n");
 #endif
 	return true;
@@ -192,7 +290,7 @@ ParseObj8AircraftCommand(
 
 static bool
 ParseObj8Command(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	// OBJ8 <group> <animate YES|NO> <filename>
 	if (tokens.size() != 4) {
@@ -229,19 +327,19 @@ ParseObj8Command(
 		}
 	}
 
-	string relativePath = tokens[3];
+	string relativePath(tokens[3]);
 	MakePartialPathNativeObj(relativePath);
 	string absolutePath(relativePath);
 	if (!DoPackageSub(absolutePath)) {
 		XPLMDump(path, lineNum, line) << XPMP_CLIENT_NAME " WARNING: package not found.\n";
 		return false;
 	}
+	// the attachment reads its bounds straight from the file, which needs
+	// the native path rather than the one we hand to the SDK.
+	const string fullPath(absolutePath);
 
 	// convert the absolute path back to a relative one
-	char xsystem[1024];
-	XPLMGetSystemPath(xsystem);
-
-	size_t sys_len = strlen(xsystem);
+	size_t sys_len = gSystemPath.size();
 	if (absolutePath.size() > sys_len) {
 		absolutePath.erase(absolutePath.begin(), absolutePath.begin() + sys_len);
 	} else {
@@ -249,7 +347,11 @@ ParseObj8Command(
 		// that said - it could also be perfectly valid, so we'll bleed it through.
 	}
 
-	auto att = Obj8Attachment::getAttachmentForFile(absolutePath);
+	std::shared_ptr<Obj8Attachment> att;
+	{
+		std::lock_guard<std::mutex> lock(gAttachmentMutex);
+		att = Obj8Attachment::getAttachmentForFile(absolutePath, fullPath);
+	}
 	myCSL->addAttachment(dt, std::move(att));
 
 	return true;
@@ -257,7 +359,7 @@ ParseObj8Command(
 
 static bool
 ParseVertOffsetCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	// VERT_OFFSET
 	// this is the csl-model vertical offset for accurately putting planes onto the ground.
@@ -271,13 +373,13 @@ ParseVertOffsetCommand(
 		return false;
 	}
 	
-	package.planes.back()->setVerticalOffset(VerticalOffsetSource::Model, stof(tokens[1].c_str()));
+	package.planes.back()->setVerticalOffset(VerticalOffsetSource::Model, stof(std::string(tokens[1])));
 	return true;
 }
 
 static bool
 ParseHasGearCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	// HASGEAR YES|NO
 	if (tokens.size() != 2 || (tokens[1] != "YES" && tokens[1] != "NO")) {
@@ -310,7 +412,7 @@ ParseHasGearCommand(
 
 static bool
 ParseIcaoCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	// ICAO <code>
 	if (tokens.size() != 2) {
@@ -323,16 +425,12 @@ ParseIcaoCommand(
 		return false;
 	}
 
-	std::string icao = tokens[1];
+	const Atom icao = Atom_Intern(tokens[1]);
 	package.planes.back()->setICAO(icao);
-	std::string group = gGroupings[icao];
-	if (package.matches[match_icao].count(icao) == 0) {
-		package.matches[match_icao][icao] = static_cast<int>(package.planes.size()) - 1;
-	}
-	if (!group.empty()) {
-		if (package.matches[match_group].count(group) == 0) {
-			package.matches[match_group][group] = static_cast<int>(package.planes.size()) - 1;
-		}
+	const Atom group = GroupForICAO(icao);
+	AddMatch(package, match_icao, icao);
+	if (group != kNoAtom) {
+		AddMatch(package, match_group, group);
 	}
 
 	return true;
@@ -340,7 +438,7 @@ ParseIcaoCommand(
 
 static bool
 ParseAirlineCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	// AIRLINE <code> <airline>
 	if (tokens.size() != 3) {
@@ -353,25 +451,19 @@ ParseAirlineCommand(
 		return false;
 	}
 
-	std::string icao = tokens[1];
-	std::string airline = tokens[2];
+	const Atom icao = Atom_Intern(tokens[1]);
+	const Atom airline = Atom_Intern(tokens[2]);
 	package.planes.back()->setAirline(icao, airline);
-	std::string group = gGroupings[icao];
-	if (package.matches[match_icao_airline].count(icao + " " + airline) == 0) {
-		package.matches[match_icao_airline][icao + " " + airline] = static_cast<int>(package.planes.size()) - 1;
-	}
+	const Atom group = GroupForICAO(icao);
+	AddMatch(package, match_icao_airline, icao, airline);
 #if USE_DEFAULTING
-	if (package.matches[match_icao		].count(icao				) == 0)
-		package.matches[match_icao		]      [icao				] = package.planes.size() - 1;
+	AddMatch(package, match_icao, icao);
 #endif
-	if (!group.empty()) {
+	if (group != kNoAtom) {
 #if USE_DEFAULTING
-		if (package.matches[match_group	     ].count(group				  ) == 0)
-			package.matches[match_group	     ]		[group				  ] = package.planes.size() - 1;
+		AddMatch(package, match_group, group);
 #endif
-		if (package.matches[match_group_airline].count(group + " " + airline) == 0) {
-			package.matches[match_group_airline][group + " " + airline] = static_cast<int>(package.planes.size()) - 1;
-		}
+		AddMatch(package, match_group_airline, group, airline);
 	}
 
 	return true;
@@ -379,7 +471,7 @@ ParseAirlineCommand(
 
 static bool
 ParseLiveryCommand(
-	const std::vector<std::string> &tokens, CSLPackage_t &package, const string &path, int lineNum, const string &line)
+	const std::vector<std::string_view> &tokens, CSLPackage_t &package, const string &path, int lineNum, std::string_view line)
 {
 	// LIVERY <code> <airline> <livery>
 	if (tokens.size() != 4) {
@@ -392,40 +484,24 @@ ParseLiveryCommand(
 		return false;
 	}
 
-	std::string icao = tokens[1];
-	std::string airline = tokens[2];
-	std::string livery = tokens[3];
+	const Atom icao = Atom_Intern(tokens[1]);
+	const Atom airline = Atom_Intern(tokens[2]);
+	const Atom livery = Atom_Intern(tokens[3]);
 	package.planes.back()->setLivery(icao, airline, livery);
-	std::string group = gGroupings[icao];
+	const Atom group = GroupForICAO(icao);
 #if USE_DEFAULTING
-	if (package.matches[match_icao				].count(icao							   ) == 0)
-		package.matches[match_icao				]	   [icao							   ] = package.planes.size() - 1;
-	if (package.matches[match_icao				].count(icao							   ) == 0)
-		package.matches[match_icao_airline 		]	   [icao + " " + airline			   ] = package.planes.size() - 1;
+	AddMatch(package, match_icao, icao);
+	AddMatch(package, match_icao_airline, icao, airline);
 #endif
-	if (package.matches[match_icao_airline_livery].count(icao + " " + airline + " " + livery) == 0) {
-		package.matches[match_icao_airline_livery][icao + " " + airline + " " + livery] =
-			static_cast<int>(package.planes.size()) - 1;
-	}
-	if (package.matches[match_icao_livery].count(icao + " " + livery) == 0) {
-		package.matches[match_icao_livery][icao + " " + livery] =
-			static_cast<int>(package.planes.size()) - 1;
-	}
-	if (!group.empty()) {
+	AddMatch(package, match_icao_airline_livery, icao, airline, livery);
+	AddMatch(package, match_icao_livery, icao, kNoAtom, livery);
+	if (group != kNoAtom) {
 #if USE_DEFAULTING
-		if (package.matches[match_group		 		 ].count(group							     ) == 0)
-			package.matches[match_group		 		 ]		[group							     ] = package.planes.size() - 1;
-		if (package.matches[match_group_airline		 ].count(group + " " + airline			     ) == 0)
-			package.matches[match_group_airline		 ]		[group + " " + airline			     ] = package.planes.size() - 1;
+		AddMatch(package, match_group, group);
+		AddMatch(package, match_group_airline, group, airline);
 #endif
-		if (package.matches[match_group_airline_livery].count(group + " " + airline + " " + livery) == 0) {
-			package.matches[match_group_airline_livery][group + " " + airline + " " + livery] =
-				static_cast<int>(package.planes.size()) - 1;
-		}
-		if (package.matches[match_group_livery].count(group + " " + livery) == 0) {
-			package.matches[match_group_livery][group + " " + livery] =
-				static_cast<int>(package.planes.size()) - 1;
-		}
+		AddMatch(package, match_group_airline_livery, group, airline, livery);
+		AddMatch(package, match_group_livery, group, kNoAtom, livery);
 	}
 
 	return true;
@@ -433,50 +509,93 @@ ParseLiveryCommand(
 
 static bool
 ParseDummyCommand(
-	const std::vector<std::string> & /* tokens */,
+	const std::vector<std::string_view> & /* tokens */,
 	CSLPackage_t & /* package */,
 	const string & /* path */,
 	int /*lineNum*/,
-	const string & /*line*/)
+	std::string_view /*line*/)
 {
 	return true;
 }
 
+// GetFileContent reads the entire file into memory with a single read.
 static std::string
 GetFileContent(const std::string &filename)
 {
 	std::string content;
-	std::ifstream in(filename, std::ios::in | std::ios::binary);
+	std::ifstream in(filename, std::ios::in | std::ios::binary | std::ios::ate);
 	if (in) {
-		content = std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		auto size = in.tellg();
+		if (size > 0) {
+			content.resize(static_cast<size_t>(size));
+			in.seekg(0);
+			in.read(&content[0], size);
+			content.resize(static_cast<size_t>(in.gcount()));
+		}
 	}
 	return content;
 }
 
+// GetNextLine finds the next newline terminated line of content, starting at
+// ioPos, and advances ioPos past it.  outLine is a view into content, so no
+// copy of the line is ever made.
+//
+// @returns false once all of content has been consumed.
+static bool
+GetNextLine(const std::string &content, size_t &ioPos, std::string_view &outLine)
+{
+	if (ioPos >= content.size()) {
+		return false;
+	}
+	size_t eol = content.find('\n', ioPos);
+	if (eol == std::string::npos) {
+		eol = content.size();
+	}
+	outLine = std::string_view(content).substr(ioPos, eol - ioPos);
+	ioPos = eol + 1;
+	return true;
+}
+
+// TokenizePackage splits the content of an xsb_aircraft.txt into the
+// tokenized lines the package parsers work from.  Blank lines and comments are
+// dropped here so they never reach the parsers (or the index cache).
+static void
+TokenizePackage(const std::string &content, TokenizedFile &outFile)
+{
+	std::string_view line;
+	std::vector<std::string_view> tokens;
+	size_t pos = 0;
+	int lineNum = 0;
+
+	outFile.clear();
+	while (GetNextLine(content, pos, line)) {
+		++lineNum;
+		trim(line);
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		tokenize(line, " \t\r\n", tokens);
+		outFile.addLine(lineNum, line, tokens);
+	}
+}
+
 static CSLPackage_t
-ParsePackageHeader(const string &path, const string &content)
+ParsePackageHeader(const string &path, const TokenizedFile &file)
 {
 	using command = std::function<bool(
-		const std::vector<std::string> &, CSLPackage_t &, const string &, int, const string &)>;
+		const std::vector<std::string_view> &, CSLPackage_t &, const string &, int, std::string_view)>;
 
-	static const std::unordered_map<std::string, command> commands{{"EXPORT_NAME", &ParseExportCommand}};
+	static const std::unordered_map<std::string_view, command> commands{{"EXPORT_NAME", &ParseExportCommand}};
 
 	CSLPackage_t package;
-	stringstream sin(content);
-	if (!sin.good()) {
-		return package;
-	}
 
-	std::string line;
-	int lineNum = 0;
-
-	while (std::getline(sin, line)) {
-		++lineNum;
-		auto tokens = tokenize(line, " \t\r\n");
+	std::vector<std::string_view> tokens;
+	for (const auto &line: file.lines) {
+		file.getTokens(line, tokens);
 		if (!tokens.empty()) {
 			auto it = commands.find(tokens[0]);
 			if (it != commands.end()) {
-				bool result = it->second(tokens, package, path, lineNum, line);
+				bool result = it->second(tokens, package, path, line.lineNum, line.text);
 				// Stop loop once we found EXPORT command
 				if (result) {
 					break;
@@ -490,12 +609,12 @@ ParsePackageHeader(const string &path, const string &content)
 
 
 static void
-ParseFullPackage(const std::string &content, CSLPackage_t &package)
+ParseFullPackage(const TokenizedFile &file, CSLPackage_t &package)
 {
 	using command = std::function<bool(
-		const std::vector<std::string> &, CSLPackage_t &, const string &, int, const string &)>;
+		const std::vector<std::string_view> &, CSLPackage_t &, const string &, int, std::string_view)>;
 
-	static const std::unordered_map<std::string, command> commands {
+	static const std::unordered_map<std::string_view, command> commands {
 		{"EXPORT_NAME", &ParseDummyCommand},
 		{"DEPENDENCY", &ParseDependencyCommand},
 		{"OBJECT", &ParseObjectCommand},
@@ -510,30 +629,19 @@ ParseFullPackage(const std::string &content, CSLPackage_t &package)
 		{ "AIRCRAFT", &ParseAircraftCommand},
 	};
 
-	stringstream sin(content);
-	if (!sin.good()) {
-		return;
-	} // exit if file not found
-
 	std::string packageFilePath(package.path);
 	packageFilePath += "/";
 	packageFilePath += "xsb_aircraft.txt";
 
-	std::string line;
-	int lineNum = 0;
-	while (std::getline(sin, line)) {
-		++lineNum;
-		trim(line);
-		if (line.empty() || line[0] == '#') {
-			continue;
-		}
-		auto tokens = tokenize(line, " \t\r\n");
+	std::vector<std::string_view> tokens;
+	for (const auto &line: file.lines) {
+		file.getTokens(line, tokens);
 		if (!tokens.empty()) {
 			auto it = commands.find(tokens[0]);
 			if (it != commands.end()) {
-				it->second(tokens, package, packageFilePath, lineNum, line);
+				it->second(tokens, package, packageFilePath, line.lineNum, line.text);
 			} else {
-				XPLMDump(packageFilePath, lineNum, line);
+				XPLMDump(packageFilePath, line.lineNum, line.text);
 			}
 		}
 	}
@@ -552,20 +660,71 @@ isPackageAlreadyLoaded(const std::string &packagePath)
 	return alreadyLoaded;
 }
 
+// TokenizeDataFile reads one of the plain data files (Doc8643.txt or
+// related.txt) line by line, tokenizing each line as it goes.  The lines are
+// collected into outStorage, which the tokens reference.
+//
+// @returns false if the file couldn't be opened.
+static bool
+TokenizeDataFile(
+	const char *path, std::string_view delim, int maxTokens, std::string &outStorage, TokenizedFile &outFile)
+{
+	FILE *fi = fopen(path, "r");
+	if (!fi) {
+		return false;
+	}
+
+	// outStorage may reallocate as we go, so record the line offsets and
+	// only create the views once it's complete.
+	vector<std::pair<size_t, size_t>> lineSpans;
+	char buf[1024];
+	outStorage.clear();
+	while (fgets_multiplatform(buf, sizeof(buf), fi)) {
+		size_t len = strlen(buf);
+		lineSpans.emplace_back(outStorage.size(), len);
+		outStorage.append(buf, len);
+	}
+	fclose(fi);
+
+	outFile.clear();
+	vector<string_view> tokens;
+	const std::string_view storage(outStorage);
+	for (size_t idx = 0; idx < lineSpans.size(); ++idx) {
+		auto line = storage.substr(lineSpans[idx].first, lineSpans[idx].second);
+		tokenize(line, delim, tokens, maxTokens);
+		outFile.addLine(static_cast<int>(idx) + 1, line, tokens);
+	}
+	return true;
+}
+
 bool
 CSL_LoadData(const char *inRelated, const char *inDoc8643)
 {
 	bool ok = true;
 
-	// read the list of aircraft codes
-	FILE *aircraft_fi = fopen(inDoc8643, "r");
+	// the data files' cache is named after the folder Doc8643.txt is in.
+	std::string dataDir(inDoc8643);
+	auto sepPos = dataDir.find_last_of("/\\");
+	dataDir = (sepPos == std::string::npos) ? std::string(".") : dataDir.substr(0, sepPos);
+	char xsystem[1024];
+	XPLMGetSystemPath(xsystem);
+	CSLIndexCache indexCache(CSLIndexCache::pathFor(xsystem, "data", dataDir));
 
-	if (aircraft_fi) {
-		char buf[1024];
-		while (fgets_multiplatform(buf, sizeof(buf), aircraft_fi)) {
-			vector<string> tokens;
+	vector<string_view> tokens;
 
-			tokens = tokenize(buf, "\t", 5);
+	// read the list of aircraft codes
+	std::string aircraftStorage;
+	TokenizedFile aircraftFile;
+	bool haveAircraft = indexCache.find(inDoc8643, aircraftFile);
+	if (!haveAircraft) {
+		haveAircraft = TokenizeDataFile(inDoc8643, "\t", 5, aircraftStorage, aircraftFile);
+		if (haveAircraft) {
+			indexCache.store(inDoc8643, aircraftFile);
+		}
+	}
+	if (haveAircraft) {
+		for (const auto &line: aircraftFile.lines) {
+			aircraftFile.getTokens(line, tokens);
 
 			// Sample line. Fields are separated by tabs
 			// ABHCO	SA-342 Gazelle 	GAZL	H1T	-
@@ -576,40 +735,53 @@ CSL_LoadData(const char *inRelated, const char *inDoc8643)
 			CSLAircraftCode_t entry;
 			entry.icao = tokens[2];
 			entry.equip = tokens[3];
-			entry.category = tokens[4][0];
+			entry.category = tokens[4].empty() ? '\0' : tokens[4][0];
 
 			gAircraftCodes[entry.icao] = entry;
 		}
-		fclose(aircraft_fi);
 	} else {
 		XPLMDump() << XPMP_CLIENT_NAME " WARNING: could not open ICAO document 8643 at " << inDoc8643 << "\n";
 		ok = false;
 	}
 
 	// next, grab the related.txt file.
-	FILE *related_fi = fopen(inRelated, "r");
-	if (related_fi) {
-		char buf[1024];
-		while (fgets_multiplatform(buf, sizeof(buf), related_fi)) {
-			if (buf[0] != ';') {
-				vector<string> tokens = tokenize(buf, " \t\r\n");
-				string group;
-				for (const auto &tok: tokens) {
-					if (!group.empty()) {
-						group += " ";
-					}
-					group += tok;
-				}
-				for (const auto &tok: tokens) {
-					gGroupings[tok] = group;
+	std::string relatedStorage;
+	TokenizedFile relatedFile;
+	bool haveRelated = indexCache.find(inRelated, relatedFile);
+	if (!haveRelated) {
+		haveRelated = TokenizeDataFile(inRelated, " \t\r\n", 0, relatedStorage, relatedFile);
+		if (haveRelated) {
+			indexCache.store(inRelated, relatedFile);
+		}
+	}
+	if (haveRelated) {
+		for (const auto &line: relatedFile.lines) {
+			if (line.text.empty() || line.text[0] == ';') {
+				continue;
+			}
+			relatedFile.getTokens(line, tokens);
+			string groupName;
+			for (const auto &tok: tokens) {
+				if (!groupName.empty()) {
+					groupName += " ";
 				}
+				groupName += tok;
+			}
+			const Atom group = Atom_Intern(groupName);
+			for (const auto &tok: tokens) {
+				gGroupings[Atom_Intern(tok)] = group;
 			}
 		}
-		fclose(related_fi);
 	} else {
 		XPLMDump() << XPMP_CLIENT_NAME " WARNING: could not open related.txt at " << inRelated << "\n";
 		ok = false;
 	}
+	indexCache.save();
+
+	// the groupings and aircraft codes feed into matching, so any previous
+	// results are now suspect.
+	CSL_RebuildMatchIndex();
+	CSL_FlushMatchCache();
 
 	return ok;
 }
@@ -653,9 +825,8 @@ CSL_LoadCSL(const char *inFolderPath)
 	free(name_buf);
 	free(index_buf);
 
-	vector<CSLPackage_t> packages;
-
-	// First read all headers. This is required to resolve the DEPENDENCIES
+	// collect the package files we're going to load, in directory order.
+	vector<string> packagePaths;
 	for (const auto &packagePath : packageDirs) {
 		std::string packageFile(packagePath);
 		packageFile += "/"; //XPLMGetDirectorySeparator();
@@ -665,38 +836,98 @@ CSL_LoadCSL(const char *inFolderPath)
 		if (!DoesFileExist(packageFile) || isPackageAlreadyLoaded(packagePath)) {
 			continue;
 		}
+		packagePaths.push_back(packagePath);
+	}
+
+	char xsystem[1024];
+	XPLMGetSystemPath(xsystem);
+	gSystemPath = xsystem;
+
+	auto loadStart = std::chrono::steady_clock::now();
+
+	// First read all headers. This is required to resolve the DEPENDENCIES
+	//
+	// The packages are parsed in parallel, but the results (and the log
+	// output from each) are merged back in directory order so the package
+	// priorities don't change.
+	//
+	// Each file is only read and tokenized once, and the result is kept for
+	// the full pass.  Packages that haven't changed since the last run are
+	// taken straight from the index cache instead.
+	const std::string indexCachePath = CSLIndexCache::pathFor(gSystemPath, "csl", inFolderPath);
+	CSLIndexCache indexCache(indexCachePath);
+	std::atomic<int> cachedPackages(0);
+
+	vector<CSLPackage_t> headers(packagePaths.size());
+	vector<string> contents(packagePaths.size());
+	vector<TokenizedFile> files(packagePaths.size());
+	vector<string> headerLogs(packagePaths.size());
+	ParallelFor(packagePaths.size(), [&](size_t idx) {
+		XPLMDumpCapture capture;
+		std::string packageFile(packagePaths[idx]);
+		packageFile += "/"; //XPLMGetDirectorySeparator();
+		packageFile += "xsb_aircraft.txt";
 
 		XPLMDump() << XPMP_CLIENT_NAME ": Loading package: " << packageFile << "\n";
-		std::string packageContent = GetFileContent(packageFile);
-		auto package = ParsePackageHeader(packagePath, packageContent);
-		if (package.hasValidHeader()) {
-			packages.push_back(package);
+		if (indexCache.find(packageFile, files[idx])) {
+			++cachedPackages;
+		} else {
+			contents[idx] = GetFileContent(packageFile);
+			TokenizePackage(contents[idx], files[idx]);
+			indexCache.store(packageFile, files[idx]);
+		}
+		headers[idx] = ParsePackageHeader(packagePaths[idx], files[idx]);
+		headerLogs[idx] = std::move(capture.text);
+	});
+
+	// the tokenized files reference the content buffers, so we track the
+	// packages by their original index rather than moving them.
+	vector<CSLPackage_t> packages;
+	vector<size_t> packageSources;
+	for (size_t idx = 0; idx < headers.size(); ++idx) {
+		XPLMDump() << headerLogs[idx];
+		if (headers[idx].hasValidHeader()) {
+			packages.push_back(std::move(headers[idx]));
+			packageSources.push_back(idx);
 		}
 	}
 
 	if (!packages.empty()) {
-		// iterator points to the first inserted package
-		auto iterator = gPackages.insert(gPackages.end(), packages.begin(), packages.end());
-
-		// Now we do a full run
-		for (; iterator != gPackages.end(); ++iterator) {
-			auto &package = *iterator;
-			std::string packageFile(package.path);
-			packageFile += "/"; //XPLMGetDirectorySeparator();
-			packageFile += "xsb_aircraft.txt";
-			std::string packageContent = GetFileContent(packageFile);
-			ParseFullPackage(packageContent, package);
+		// offset of the first inserted package
+		const size_t firstPackage = gPackages.size();
+		gPackages.insert(gPackages.end(), packages.begin(), packages.end());
+
+		// Now we do a full run.  Each worker fills in its own copy of the
+		// package so gPackages remains stable (and readable for dependency
+		// and path resolution) until they're all done.
+		vector<string> packageLogs(packages.size());
+		ParallelFor(packages.size(), [&](size_t idx) {
+			XPLMDumpCapture capture;
+			const size_t source = packageSources[idx];
+			ParseFullPackage(files[source], packages[idx]);
+			files[source].clear();
+			contents[source].clear();
+			contents[source].shrink_to_fit();
+			packageLogs[idx] = std::move(capture.text);
+		});
+
+		for (size_t idx = 0; idx < packages.size(); ++idx) {
+			XPLMDump() << packageLogs[idx];
+			gPackages[firstPackage + idx] = std::move(packages[idx]);
 		}
+		CSL_RebuildMatchIndex();
+		CSL_FlushMatchCache();
 	}
 
-#if 0
-	::Microseconds((UnsignedWide*) &t2);
-	double delta = (t2 - t1);
-	delta /= 1000000.0;
+	if (!indexCache.save()) {
+		XPLMDump() << XPMP_CLIENT_NAME " WARNING: could not write the CSL index cache " << indexCachePath << "\n";
+	}
+
+	std::chrono::duration<double> loadTime = std::chrono::steady_clock::now() - loadStart;
 	char buf[256];
-	sprintf(buf,"CSL full load took: %lf\n", delta);
+	snprintf(buf, sizeof(buf), XPMP_CLIENT_NAME ": CSL load of %d packages (%d from the index cache) took %.3lf seconds\n",
+		static_cast<int>(packages.size()), cachedPackages.load(), loadTime.count());
 	XPLMDebugString(buf);
-#endif
 	return ok;
 }
 
@@ -716,16 +947,164 @@ static const int kUseICAO[] = {1, 1, 0, 0, 1, 1, 0, 0};
 static const int kUseAirline[] = {1, 1, 1, 1, 0, 0, 0, 0};
 static const int kUseLivery[] = {1, 0, 1, 0, 1, 0, 1, 0};
 
-CSL *
-CSL_MatchPlane(const PlaneType &type,int *match_quality, bool allow_default)
+// gMatchIndex merges the match tables of every package so each key maps
+// straight to the highest priority usable CSL.  This saves us from walking
+// every package for every pass - a lookup is at most one probe per pass.
+static std::unordered_map<CSLMatchKey_t, CSL *, CSLMatchKeyHash>	gMatchIndex[match_count];
+
+// gFallbackIndex buckets the generic (ICAO only) models by their doc8643
+// equipment for each of the equipment fallback passes.  Only the first usable
+// candidate in package priority order is kept, as it's the only one that can
+// ever be returned.
+struct CSLFallbackCandidate_t {
+	CSL *	csl;
+	Atom	icao;
+};
+
+static std::unordered_map<std::string, CSLFallbackCandidate_t>	gFallbackIndex[match_fallback_count];
+
+static char
+EquipAt(const CSLAircraftCode_t &code, size_t idx)
+{
+	return (idx < code.equip.size()) ? code.equip[idx] : '\0';
+}
+
+// FallbackKey builds the bucket key for the equipment fallback pass.  All
+// passes require the WTC category to match, so it always leads the key.
+static std::string
+FallbackKey(int pass, const CSLAircraftCode_t &code)
+{
+	std::string key(1, code.category);
+	switch (pass) {
+	case match_fallback_wtc_fullconfig:	// perfect match of equipment.
+		key += code.equip;
+		break;
+	case match_fallback_wtc_engines_enginetype:
+		key += EquipAt(code, 1);
+		key += EquipAt(code, 2);
+		break;
+	case match_fallback_wtc_engines:
+		key += EquipAt(code, 1);
+		break;
+	case match_fallback_wtc_enginetype:
+		key += EquipAt(code, 2);
+		break;
+	default:
+		break;
+	}
+	return key;
+}
+
+// CSL_RebuildMatchIndex must be called whenever gPackages, gGroupings or
+// gAircraftCodes changes.
+static void
+CSL_RebuildMatchIndex()
 {
-	string group;
-	string key;
+	for (auto &table: gMatchIndex) {
+		table.clear();
+	}
+	for (auto &table: gFallbackIndex) {
+		table.clear();
+	}
+	// gPackages is in priority order, and emplace never replaces an existing
+	// key, so the first usable CSL we see for each key is the one that sticks.
+	for (const auto &package: gPackages) {
+		for (int n = 0; n < match_count; ++n) {
+			for (const auto &match: package.matches[n]) {
+				CSL *csl = package.planes[match.second];
+				if (!csl->isUsable()) {
+					continue;
+				}
+				gMatchIndex[n].emplace(match.first, csl);
+			}
+		}
 
-	auto group_iter = gGroupings.find(type.mICAO);
-	if (group_iter != gGroupings.end()) {
-		group = group_iter->second;
+		// now the generic aircraft types for the equipment fallback.  These are
+		// visited in the order they appear in the package so the winner
+		// doesn't depend on the hash table's iteration order.
+		std::vector<std::pair<int, Atom>> generics;
+		generics.reserve(package.matches[match_icao].size());
+		for (const auto &match: package.matches[match_icao]) {
+			generics.emplace_back(match.second, match.first.primary);
+		}
+		std::sort(generics.begin(), generics.end());
+		for (const auto &generic: generics) {
+			CSL *csl = package.planes[generic.first];
+			if (!csl->isUsable()) {
+				continue;
+			}
+			const auto code = gAircraftCodes.find(Atom_String(generic.second));
+			if (code == gAircraftCodes.end()) {
+				continue;
+			}
+			for (int pass = 0; pass < match_fallback_count; ++pass) {
+				// the partial configuration passes only consider well-formed
+				// equipment codes.
+				if (pass != match_fallback_wtc_fullconfig && pass != match_fallback_wtc &&
+					code->second.equip.length() != 3) {
+					continue;
+				}
+				gFallbackIndex[pass].emplace(FallbackKey(pass, code->second), CSLFallbackCandidate_t{csl, generic.second});
+			}
+		}
 	}
+}
+
+// gMatchCache memoises the results of CSL_MatchPlane.  Online networks send
+// us the same few thousand types over and over, so a repeat spawn should only
+// cost us a single hash lookup.
+struct CSLMatchCacheKey_t {
+	PlaneType	type;
+	bool		allowDefault;
+
+	bool operator==(const CSLMatchCacheKey_t &other) const
+	{
+		return allowDefault == other.allowDefault && type == other.type;
+	}
+};
+
+struct CSLMatchCacheKeyHash {
+	size_t operator()(const CSLMatchCacheKey_t &key) const
+	{
+		return key.type.hash() ^ (key.allowDefault ? 1 : 0);
+	}
+};
+
+struct CSLMatchCacheEntry_t {
+	CSL *	csl;
+	int		matchQuality;
+};
+
+static std::unordered_map<CSLMatchCacheKey_t, CSLMatchCacheEntry_t, CSLMatchCacheKeyHash>	gMatchCache;
+static unsigned long		gMatchCacheHits = 0;
+static unsigned long		gMatchCacheMisses = 0;
+
+void
+CSL_FlushMatchCache()
+{
+	gMatchCache.clear();
+}
+
+void
+CSL_GetMatchCacheStats(unsigned long *outHits, unsigned long *outMisses)
+{
+	if (outHits) {
+		*outHits = gMatchCacheHits;
+	}
+	if (outMisses) {
+		*outMisses = gMatchCacheMisses;
+	}
+}
+
+CSL *
+CSL_MatchPlaneUncached(const PlaneType &type, int *match_quality, bool allow_default)
+{
+	// only look up the type's codes - a string we've never interned can't be
+	// in any of the tables, and interning it would grow the table forever.
+	const Atom icao = Atom_Find(type.getICAO());
+	const Atom group = GroupForICAO(icao);
+	const Atom airline = Atom_Find(type.getAirline());
+	const Atom livery = type.getLiveryAtom();
 
 	char buf[4096];
 
@@ -735,82 +1114,73 @@ CSL_MatchPlane(const PlaneType &type,int *match_quality, bool allow_default)
 			4096,
 			XPMP_CLIENT_NAME " MATCH - %s - GROUP=%s\n",
 			type.toLongString().c_str(),
-			group.c_str());
+			Atom_String(group).c_str());
 		XPLMDebugString(buf);
 	}
 
 	// Now we go through our passes.
 	for (int n = 0; n < match_count; ++n) {
 		// Build up the right key for this pass.
-		key = kUseICAO[n]?type.mICAO:group;
-		if (!kUseICAO[n] && group.empty()) {
+		CSLMatchKey_t key{kUseICAO[n]?icao:group, kNoAtom, kNoAtom};
+		if (!kUseICAO[n] && group == kNoAtom) {
 			if (gConfiguration.debug.modelMatching) {
 				sprintf(buf, XPMP_CLIENT_NAME " MATCH -    Skipping %d Due nil Group\n", n);
 				XPLMDebugString(buf);
 			}
+			continue;
 		}
 
 		if (kUseAirline[n]) {
-			if (type.mAirline.empty()) {
+			if (type.getAirline().empty()) {
 				if (gConfiguration.debug.modelMatching) {
 					sprintf(buf, XPMP_CLIENT_NAME " MATCH -    Skipping %d Due Absent Airline\n", n);
 					XPLMDebugString(buf);
 				}
 				continue;
 			}
-			key += " ";
-			key += type.mAirline;
+			key.airline = airline;
 		}
 
 		if (kUseLivery[n]) {
-			if (type.mLivery.empty()) {
+			if (type.getLivery().empty()) {
 				if (gConfiguration.debug.modelMatching) {
 					sprintf(buf, XPMP_CLIENT_NAME " MATCH -    Skipping %d Due Absent Livery\n", n);
 					XPLMDebugString(buf);
 				}
 				continue;
 			}
-			key += " ";
-			key += type.mLivery;
+			key.livery = livery;
 		}
 
 		if (gConfiguration.debug.modelMatching) {
-			sprintf(buf, XPMP_CLIENT_NAME " MATCH -    Group %d key %s\n", n, key.c_str());
+			std::string keyString(kUseICAO[n]?type.getICAO():Atom_String(group));
+			if (kUseAirline[n]) {
+				keyString += " ";
+				keyString += type.getAirline();
+			}
+			if (kUseLivery[n]) {
+				keyString += " " + type.getLivery();
+			}
+			snprintf(buf, 4096, XPMP_CLIENT_NAME " MATCH -    Group %d key %s\n", n, keyString.c_str());
 			XPLMDebugString(buf);
 		}
 
-		// Now go through each group and see if we match.
-		for (const auto &package: gPackages) {
-			auto iter = package.matches[n].find(key);
-			if (iter != package.matches[n].end()) {
-				if (!package.planes[iter->second]->isUsable()) {
-					if (gConfiguration.debug.modelMatching) {
-						sprintf(
-							buf,
-							XPMP_CLIENT_NAME " MATCH - Skipping as not usable. Found: %s/%s/%s : %s\n",
-							package.planes[iter->second]->getICAO().c_str(),
-							package.planes[iter->second]->getAirline().c_str(),
-							package.planes[iter->second]->getLivery().c_str(),
-							package.planes[iter->second]->getModelName().c_str());
-						XPLMDebugString(buf);
-					}
-					continue;
-				}
-				if (nullptr != match_quality) {
-					*match_quality = n;
-				}
-				if (gConfiguration.debug.modelMatching) {
-					sprintf(
-						buf,
-						XPMP_CLIENT_NAME " MATCH - Found: %s/%s/%s : %s\n",
-						package.planes[iter->second]->getICAO().c_str(),
-						package.planes[iter->second]->getAirline().c_str(),
-						package.planes[iter->second]->getLivery().c_str(),
-						package.planes[iter->second]->getModelName().c_str());
-					XPLMDebugString(buf);
-				}
-				return package.planes[iter->second];
+		auto iter = gMatchIndex[n].find(key);
+		if (iter != gMatchIndex[n].end()) {
+			if (nullptr != match_quality) {
+				*match_quality = n;
+			}
+			if (gConfiguration.debug.modelMatching) {
+				sprintf(
+					buf,
+					XPMP_CLIENT_NAME " MATCH - Found: %s/%s/%s : %s\n",
+					iter->second->getICAO().c_str(),
+					iter->second->getAirline().c_str(),
+					iter->second->getLivery().c_str(),
+					iter->second->getModelName().c_str());
+				XPLMDebugString(buf);
 			}
+			return iter->second;
 		}
 	}
 
@@ -825,7 +1195,7 @@ CSL_MatchPlane(const PlaneType &type,int *match_quality, bool allow_default)
 	// For each aircraft, we know the equipment type "L2T" and the WTC category.
 	// try to find a model that has the same equipment type and WTC
 
-	const auto model_it = gAircraftCodes.find(type.mICAO);
+	const auto model_it = gAircraftCodes.find(std::string(type.getICAO()));
 	if (model_it != gAircraftCodes.end()) {
 		if (gConfiguration.debug.modelMatching) {
 			XPLMDebugString(XPMP_CLIENT_NAME " MATCH/eqp-fallback - Looking for a ");
@@ -852,80 +1222,46 @@ CSL_MatchPlane(const PlaneType &type,int *match_quality, bool allow_default)
 		// 3. match WTC, #egines ("2")
 		// 4. match WTC, enginetype ("P")
 		// 5. match WTC
-		for (int pass = 0; pass <= match_fallback_count; ++pass) {
+		for (int pass = 0; pass < match_fallback_count; ++pass) {
 
 			if (gConfiguration.debug.modelMatching) {
 				switch (pass) {
-				case 1:
+				case match_fallback_wtc_fullconfig:
 					XPLMDebugString(XPMP_CLIENT_NAME " Match/eqp-fallback - matching WTC and configuration\n");
 					break;
-				case 2:
+				case match_fallback_wtc_engines_enginetype:
 					XPLMDebugString(XPMP_CLIENT_NAME " Match/eqp-fallback - matching WTC, #engines and enginetype\n");
 					break;
-				case 3:
+				case match_fallback_wtc_engines:
 					XPLMDebugString(XPMP_CLIENT_NAME " Match/eqp-fallback - matching WTC, #engines\n");
 					break;
-				case 4:
+				case match_fallback_wtc_enginetype:
 					XPLMDebugString(XPMP_CLIENT_NAME " Match/eqp-fallback - matching WTC, enginetype\n");
 					break;
-				case 5:
+				case match_fallback_wtc:
 					XPLMDebugString(XPMP_CLIENT_NAME " Match/eqp-fallback - matching WTC\n");
 					break;
 				}
 			}
 
-
-			for (const auto &package: gPackages) {
-				// now we traverse all generic aircraft types in the package
-				for (const auto &matchpair: package.matches[match_icao]) {
-					if (package.planes[matchpair.second]->isUsable()) {
-						// we have a candidate, lets see if it matches our criteria
-						const auto m = gAircraftCodes.find(matchpair.first);
-						if (m != gAircraftCodes.end()) {
-							// category
-							if (m->second.category != model_it->second.category) {
-								continue;
-							}
-							switch (pass) {
-							case match_fallback_wtc_fullconfig:	// perfect match of equipment.
-								if (m->second.equip != model_it->second.equip)
-									continue;
-								break;
-							case match_fallback_wtc_engines_enginetype:
-								// this case will be caught by the enginetype case matching.
-							case match_fallback_wtc_engines:
-								if (m->second.equip[1] != model_it->second.equip[1])
-									continue;
-							case match_fallback_wtc_enginetype:
-								if (m->second.equip.length() != 3) {
-									continue;
-								}
-								if ((pass != match_fallback_wtc_engines) &&
-									(m->second.equip[2] != model_it->second.equip[2])) {
-									continue;
-								}
-							default:
-								break;
-							}
-							// bingo
-							if (gConfiguration.debug.modelMatching) {
-								XPLMDebugString(XPMP_CLIENT_NAME " MATCH/eqp-fallback - found: ");
-								XPLMDebugString(matchpair.first.c_str());
-								XPLMDebugString("\n");
-							}
-							if (match_quality != nullptr) {
-								*match_quality = match_count + pass;
-							}
-							return package.planes[matchpair.second];
-						}
-					}
+			auto iter = gFallbackIndex[pass].find(FallbackKey(pass, model_it->second));
+			if (iter != gFallbackIndex[pass].end()) {
+				// bingo
+				if (gConfiguration.debug.modelMatching) {
+					XPLMDebugString(XPMP_CLIENT_NAME " MATCH/eqp-fallback - found: ");
+					XPLMDebugString(Atom_String(iter->second.icao).c_str());
+					XPLMDebugString("\n");
+				}
+				if (match_quality != nullptr) {
+					*match_quality = match_count + pass;
 				}
+				return iter->second.csl;
 			}
 		}
 	}
 
 	if (gConfiguration.debug.modelMatching) {
-		XPLMDebugString(string("gAircraftCodes.find(" + type.mICAO + ") returned no match.\n").c_str());
+		XPLMDebugString(("gAircraftCodes.find(" + std::string(type.getICAO()) + ") returned no match.\n").c_str());
 	}
 
 	if (type.compare(gDefaultPlane, Mask_ICAO)) {
@@ -946,9 +1282,51 @@ CSL_MatchPlane(const PlaneType &type,int *match_quality, bool allow_default)
 	return defCSL;
 }
 
+CSL *
+CSL_MatchPlane(const PlaneType &type, int *match_quality, bool allow_default)
+{
+	CSLMatchCacheKey_t key{type, allow_default};
+
+	auto iter = gMatchCache.find(key);
+	if (iter != gMatchCache.end()) {
+		++gMatchCacheHits;
+		if (gConfiguration.debug.modelMatching) {
+			XPLMDump()
+				<< XPMP_CLIENT_NAME " MATCH - "
+				<< type.toLongString()
+				<< " - cached: "
+				<< (iter->second.csl ? iter->second.csl->getModelName() : string("no match"))
+				<< "\n";
+		}
+		if (nullptr != match_quality) {
+			*match_quality = iter->second.matchQuality;
+		}
+		return iter->second.csl;
+	}
+	++gMatchCacheMisses;
+
+	CSLMatchCacheEntry_t entry{nullptr, -1};
+	entry.csl = CSL_MatchPlaneUncached(type, &entry.matchQuality, allow_default);
+	gMatchCache.emplace(std::move(key), entry);
+
+	if (nullptr != match_quality) {
+		*match_quality = entry.matchQuality;
+	}
+	return entry.csl;
+}
+
 void
 CSL_Dump()
 {
+	XPLMDump()
+		<< XPMP_CLIENT_NAME " CSL: Match cache "
+		<< gMatchCache.size()
+		<< " entries, "
+		<< static_cast<int>(gMatchCacheHits)
+		<< " hits, "
+		<< static_cast<int>(gMatchCacheMisses)
+		<< " misses\n";
+
 	// DIAGNOSTICS - print out everything we know.
 	for (const auto &package: gPackages) {
 		XPLMDump() << XPMP_CLIENT_NAME " CSL: Package " << package.name << "\n";
@@ -963,7 +1341,7 @@ CSL_Dump()
 		for (int t = 0; t < match_count; ++t) {
 			XPLMDump() << XPMP_CLIENT_NAME " CSL:           Table " << t << "\n";
 			for (const auto &i: package.matches[t]) {
-				XPLMDump() << XPMP_CLIENT_NAME " CSL:                " << i.first << " -> " << i.second << "\n";
+				XPLMDump() << XPMP_CLIENT_NAME " CSL:                " << MatchKeyString(i.first) << " -> " << i.second << "\n";
 			}
 		}
 	}
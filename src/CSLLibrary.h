@@ -87,6 +87,25 @@ bool			CSL_LoadCSL(const char *inFolderPath);
  */
 CSL *			CSL_MatchPlane(const PlaneType &type,int *match_quality, bool allow_default);
 
+/** CSL_MatchPlaneUncached is CSL_MatchPlane without the match cache - it
+ * always does the full match.  It's exposed for the benchmarks.
+ */
+CSL *			CSL_MatchPlaneUncached(const PlaneType &type, int *match_quality, bool allow_default);
+
+/** CSL_FlushMatchCache discards all memoised CSL_MatchPlane results.
+ *
+ * This must be called whenever something that feeds into model matching (the
+ * package list, the groupings or the default plane) changes.
+ */
+void			CSL_FlushMatchCache();
+
+/** CSL_GetMatchCacheStats reports how effective the match cache has been.
+ *
+ * @param outHits if not null, set to the number of lookups answered from the cache
+ * @param outMisses if not null, set to the number of lookups that required a full match
+ */
+void			CSL_GetMatchCacheStats(unsigned long *outHits, unsigned long *outMisses);
+
 /*
  * CSL_Dump
  *
@@ -23,10 +23,18 @@
  */
 
 #include "CullInfo.h"
+#include <cmath>
 #include <XPLMDataAccess.h>
 
 #include "XUtils.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULL_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define CULL_USE_SSE 0
+#endif
+
 
 XPLMDataRef		CullInfo::projectionMatrixRef = nullptr;
 XPLMDataRef		CullInfo::modelviewMatrixRef = nullptr;
@@ -67,6 +75,19 @@ CullInfo::normalizeMatrix(float vec[4])
 	}
 }
 
+void
+CullInfo::normalizePlane(float plane[4])
+{
+	const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+	if (length > 0.0f) {
+		const float scale = 1.0f / length;
+		plane[0] *= scale;
+		plane[1] *= scale;
+		plane[2] *= scale;
+		plane[3] *= scale;
+	}
+}
+
 
 CullInfo::CullInfo()
 {
@@ -102,6 +123,17 @@ CullInfo::CullInfo()
 
 	nea_clip[0] = proj[2]+proj[3];	nea_clip[1] = proj[6]+proj[7];	nea_clip[2] = proj[10]+proj[11];nea_clip[3] = proj[14]+proj[15];
 	far_clip[0] =-proj[2]+proj[3];	far_clip[1] =-proj[6]+proj[7];	far_clip[2] =-proj[10]+proj[11];far_clip[3] =-proj[14]+proj[15];
+
+	// None of these come out unit length, so the plane equation gives a
+	// distance scaled by a different amount for each plane, and comparing it
+	// with a radius in metres culls spheres that still poke into the view.
+	// Normalising them makes the plane equation the distance in metres.
+	normalizePlane(lft_clip);
+	normalizePlane(rgt_clip);
+	normalizePlane(bot_clip);
+	normalizePlane(top_clip);
+	normalizePlane(nea_clip);
+	normalizePlane(far_clip);
 }
 
 CullInfo::CullInfo(const CullInfo &src)
@@ -160,6 +192,92 @@ CullInfo::SphereDistanceSqr(float x, float y, float z) const
 	return xp*xp+yp*yp+zp*zp;
 }
 
+#if CULL_USE_SSE
+/** ClipMask4 returns a lane mask of the spheres which lie entirely outside
+ * the clip plane.  This is checkClip for 4 spheres at once.
+ */
+static inline __m128
+ClipMask4(__m128 ex, __m128 ey, __m128 ez, __m128 r, const float clip[4])
+{
+	__m128 d = _mm_mul_ps(ex, _mm_set1_ps(clip[0]));
+	d = _mm_add_ps(d, _mm_mul_ps(ey, _mm_set1_ps(clip[1])));
+	d = _mm_add_ps(d, _mm_mul_ps(ez, _mm_set1_ps(clip[2])));
+	d = _mm_add_ps(d, _mm_set1_ps(clip[3]));
+	d = _mm_add_ps(d, r);
+	return _mm_cmplt_ps(d, _mm_setzero_ps());
+}
+#endif
+
+void
+CullInfo::SpheresVisible(
+	size_t count,
+	const float *x,
+	const float *y,
+	const float *z,
+	const float *r,
+	uint8_t *outVisible,
+	float *outDistanceSqr) const
+{
+	size_t i = 0;
+#if CULL_USE_SSE
+	const float *m = model_view;
+	for (; i + 4 <= count; i += 4) {
+		const __m128 vx = _mm_loadu_ps(x + i);
+		const __m128 vy = _mm_loadu_ps(y + i);
+		const __m128 vz = _mm_loadu_ps(z + i);
+		const __m128 vr = _mm_loadu_ps(r + i);
+
+		// into eye coordinates, in the same order of operations as
+		// multMatrixVec4f so the results match the scalar tests exactly.
+		__m128 ex = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(vx, _mm_set1_ps(m[0])), _mm_mul_ps(vy, _mm_set1_ps(m[4]))),
+			_mm_mul_ps(vz, _mm_set1_ps(m[8]))), _mm_set1_ps(m[12]));
+		__m128 ey = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(vx, _mm_set1_ps(m[1])), _mm_mul_ps(vy, _mm_set1_ps(m[5]))),
+			_mm_mul_ps(vz, _mm_set1_ps(m[9]))), _mm_set1_ps(m[13]));
+		__m128 ez = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(vx, _mm_set1_ps(m[2])), _mm_mul_ps(vy, _mm_set1_ps(m[6]))),
+			_mm_mul_ps(vz, _mm_set1_ps(m[10]))), _mm_set1_ps(m[14]));
+		const __m128 ew = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(vx, _mm_set1_ps(m[3])), _mm_mul_ps(vy, _mm_set1_ps(m[7]))),
+			_mm_mul_ps(vz, _mm_set1_ps(m[11]))), _mm_set1_ps(m[15]));
+
+		// the distance is taken before the perspective divide.
+		const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez));
+		_mm_storeu_ps(outDistanceSqr + i, dist);
+
+		// normalizeMatrix, skipping any lanes where w is 0.
+		const __m128 hasW = _mm_cmpneq_ps(ew, _mm_setzero_ps());
+		const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), ew);
+		ex = _mm_or_ps(_mm_and_ps(hasW, _mm_mul_ps(ex, invW)), _mm_andnot_ps(hasW, ex));
+		ey = _mm_or_ps(_mm_and_ps(hasW, _mm_mul_ps(ey, invW)), _mm_andnot_ps(hasW, ey));
+		ez = _mm_or_ps(_mm_and_ps(hasW, _mm_mul_ps(ez, invW)), _mm_andnot_ps(hasW, ez));
+
+		__m128 culled = ClipMask4(ex, ey, ez, vr, nea_clip);
+		culled = _mm_or_ps(culled, ClipMask4(ex, ey, ez, vr, bot_clip));
+		culled = _mm_or_ps(culled, ClipMask4(ex, ey, ez, vr, top_clip));
+		culled = _mm_or_ps(culled, ClipMask4(ex, ey, ez, vr, lft_clip));
+		culled = _mm_or_ps(culled, ClipMask4(ex, ey, ez, vr, rgt_clip));
+		culled = _mm_or_ps(culled, ClipMask4(ex, ey, ez, vr, far_clip));
+		const int culledBits = _mm_movemask_ps(culled);
+		outVisible[i + 0] = (culledBits & 1) ? 0 : 1;
+		outVisible[i + 1] = (culledBits & 2) ? 0 : 1;
+		outVisible[i + 2] = (culledBits & 4) ? 0 : 1;
+		outVisible[i + 3] = (culledBits & 8) ? 0 : 1;
+	}
+#endif
+	for (; i < count; ++i) {
+		outVisible[i] = SphereIsVisible(x[i], y[i], z[i], r[i]) ? 1 : 0;
+		outDistanceSqr[i] = SphereDistanceSqr(x[i], y[i], z[i]);
+	}
+}
+
+float
+CullInfo::ProjectionScale() const
+{
+	return proj[5];
+}
+
 void
 CullInfo::ConvertTo2D(float x, float y, float z, float w, float * out_x, float * out_y) const
 {
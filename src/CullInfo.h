@@ -25,6 +25,9 @@
 #ifndef CULLINFO_H
 #define CULLINFO_H
 
+#include <cstddef>
+#include <cstdint>
+
 #include <XPLMDataAccess.h>
 
 // This struct has everything we need to cull fast!
@@ -44,8 +47,9 @@ public:
 
     CullInfo(const CullInfo &src);
 
-    /** SphereIsVisible performs a visibility check at the location (in view
-     * coordinates) x,y,z to determine if a sphere of radius r would be visible.
+    /** SphereIsVisible performs a visibility check at the location (in local
+     * OpenGL coordinates) x,y,z to determine if a sphere of radius r metres
+     * would be visible.
      */
     bool SphereIsVisible(float x, float y, float z, float r) const;
 
@@ -61,18 +65,44 @@ public:
      */
     float SphereDistanceSqr(float x, float y, float z) const;
 
+    /** SpheresVisible is the batched form of SphereIsVisible and
+     * SphereDistanceSqr, and produces identical results.  It uses SSE where
+     * the target guarantees it, and falls back to the scalar tests otherwise.
+     *
+     * @param count the number of spheres
+     * @param x,y,z,r arrays of count sphere centres (in local OpenGL
+     *     coordinates) and radii in metres
+     * @param outVisible array of count flags set to 1 if the sphere is
+     *     visible, otherwise 0
+     * @param outDistanceSqr array of count squared distances from the camera
+     */
+    void SpheresVisible(
+        size_t count,
+        const float *x,
+        const float *y,
+        const float *z,
+        const float *r,
+        uint8_t *outVisible,
+        float *outDistanceSqr) const;
+
     /** ConvertTo2D projects the provided world coordinates into screen
      * coordinates using the projection & modelview matrices in the CullInfo
      * object
      */
     void ConvertTo2D(float x, float y, float z, float w, float *out_x, float *out_y) const;
 
+    /** ProjectionScale returns the vertical scale of the projection matrix
+     * (the cotangent of half the vertical field of view).  An object's size
+     * on screen is proportional to this over its distance.
+     */
+    float ProjectionScale() const;
+
 protected:
     float model_view[16];	// The model view matrix, to get from local OpenGL to eye coordinates.
     float proj[16];			// Proj matrix - this is just a hack to use for gluProject.
-    float nea_clip[4];		// Four clip planes in the form of Ax + By + Cz + D = 0 (ABCD are in the array.)
-    float far_clip[4];		// They are oriented so the positive side of the clip plane is INSIDE the view volume.
-    float lft_clip[4];
+    float nea_clip[4];		// Six clip planes in the form of Ax + By + Cz + D = 0 (ABCD are in the array.)
+    float far_clip[4];		// They are oriented so the positive side of the clip plane is INSIDE the view volume,
+    float lft_clip[4];		// and normalised so Ax + By + Cz + D is the distance from the plane.
     float rgt_clip[4];
     float bot_clip[4];
     float top_clip[4];
@@ -83,6 +113,7 @@ private:
 
 	static void multMatrixVec4f(float dst[4], const float m[16], const float v[4]);
 	static void normalizeMatrix(float vec[4]);
+	static void normalizePlane(float plane[4]);
 	static bool	checkClip(const float eye[4], const float clip[4], float r);
 };
 
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef FRAMECONTEXT_H
+#define FRAMECONTEXT_H
+
+#include "CullInfo.h"
+
+/** FrameContext carries the sim state the per-plane work needs.
+ *
+ * It's built once per frame by Render_PrepLists and passed down through all
+ * of the per-plane updates, so the number of dataref reads doesn't grow with
+ * the number of planes.
+ */
+struct FrameContext {
+	CullInfo	camera;				// the view matrices, for culling
+	double		cameraX;			// the camera's position in local coordinates
+	double		cameraY;
+	double		cameraZ;
+	float		zoom;				// the camera's zoom factor
+	float		visibility;			// the horizontal visibility in metres, or infinite if unknown
+	float		fullRenderDistance;	// the distance (in metres) out to which planes are fully rendered
+	float		lowDetailDistance;	// the distance (in metres) out to which planes may use their low detail models
+	float		lodScale;			// how much the level of detail distances are stretched by zooming in
+	double		ownshipAltitude;	// the user's aircraft elevation in feet
+};
+
+#endif //FRAMECONTEXT_H
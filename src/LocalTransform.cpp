@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "LocalTransform.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <XPLMGraphics.h>
+
+#include "XPMPMultiplayerVars.h"
+
+// metres per degree of arc, only used to decide when to re-anchor.
+static const double kMetersPerDegree = 60.0 * 1852.0;
+
+// the steps used to measure the expansion's terms.
+static const double kStepArc = 0.05;
+static const double kStepElevation = 500.0;
+
+// beyond this latitude, longitude is too badly behaved to expand in.
+static const double kMaxAnchorLatitude = 85.0;
+
+// wrapLongitude brings a difference in longitude into [-180, 180].  It's
+// written to compile down to selects, rather than a call to floor.
+static inline double
+wrapLongitude(double dlon)
+{
+	dlon = (dlon > 180.0) ? dlon - 360.0 : dlon;
+	return (dlon < -180.0) ? dlon + 360.0 : dlon;
+}
+
+LocalTransform::LocalTransform() :
+	mLat(0.0),
+	mLon(0.0),
+	mElevation(0.0),
+	mLonScale(1.0),
+	mRadius(-1.0),
+	mCoeff{},
+	mAnchorLocal{},
+	mAnchored(false),
+	mOriginEpoch(0)
+{
+}
+
+void
+LocalTransform::sample(double u, double v, double w, double out[3]) const
+{
+	XPLMWorldToLocal(mLat + u, mLon + v / mLonScale, mElevation + w, &out[0], &out[1], &out[2]);
+}
+
+void
+LocalTransform::evaluate(double u, double v, double w, double out[3]) const
+{
+	for (int axis = 0; axis < 3; axis++) {
+		const double *c = mCoeff[axis];
+		out[axis] = c[kTermConst] + c[kTermU] * u + c[kTermV] * v + c[kTermW] * w
+			+ c[kTermUU] * u * u + c[kTermVV] * v * v + c[kTermWW] * w * w
+			+ c[kTermUV] * u * v + c[kTermUW] * u * w + c[kTermVW] * v * w
+			+ (c[kTermUUW] * u * u + c[kTermVVW] * v * v + c[kTermUVW] * u * v) * w;
+	}
+}
+
+bool
+LocalTransform::isAccurate(double radius) const
+{
+	for (const double elevation: {kMinElevation, kMaxElevation}) {
+		const double w = elevation - mElevation;
+		for (int i = -1; i <= 1; i++) {
+			for (int j = -1; j <= 1; j++) {
+				if (i == 0 && j == 0) {
+					continue;
+				}
+				double exact[3], fitted[3];
+				sample(i * radius, j * radius, w, exact);
+				evaluate(i * radius, j * radius, w, fitted);
+				const double dx = exact[0] - fitted[0];
+				const double dy = exact[1] - fitted[1];
+				const double dz = exact[2] - fitted[2];
+				const double ax = exact[0] - mCoeff[0][kTermConst];
+				const double ay = exact[1] - mCoeff[1][kTermConst];
+				const double az = exact[2] - mCoeff[2][kTermConst];
+				const double limit = std::max(kMaxError, kMaxRelativeError * std::sqrt(ax * ax + ay * ay + az * az));
+				if (dx * dx + dy * dy + dz * dz > limit * limit) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void
+LocalTransform::refit(double lat, double lon, double elevation)
+{
+	mLat = lat;
+	mLon = lon;
+	mElevation = elevation;
+	mRadius = -1.0;
+	mAnchored = true;
+	mLonScale = 1.0;
+	sample(0, 0, 0, mAnchorLocal);
+	if (std::fabs(lat) > kMaxAnchorLatitude) {
+		return;
+	}
+	mLonScale = std::cos(lat * M_PI / 180.0);
+
+	// central differences for every term.
+	const double du = kStepArc, dv = kStepArc, dw = kStepElevation;
+	double f0[3], up[3], um[3], vp[3], vm[3], wp[3], wm[3];
+	double uvpp[3], uvpm[3], uvmp[3], uvmm[3];
+	double uwpp[3], uwpm[3], uwmp[3], uwmm[3];
+	double vwpp[3], vwpm[3], vwmp[3], vwmm[3];
+	double uvwppp[3], uvwpmp[3], uvwmpp[3], uvwmmp[3];
+	double uvwppm[3], uvwpmm[3], uvwmpm[3], uvwmmm[3];
+	std::copy(mAnchorLocal, mAnchorLocal + 3, f0);
+	sample(du, 0, 0, up);
+	sample(-du, 0, 0, um);
+	sample(0, dv, 0, vp);
+	sample(0, -dv, 0, vm);
+	sample(0, 0, dw, wp);
+	sample(0, 0, -dw, wm);
+	sample(du, dv, 0, uvpp);
+	sample(du, -dv, 0, uvpm);
+	sample(-du, dv, 0, uvmp);
+	sample(-du, -dv, 0, uvmm);
+	sample(du, 0, dw, uwpp);
+	sample(du, 0, -dw, uwpm);
+	sample(-du, 0, dw, uwmp);
+	sample(-du, 0, -dw, uwmm);
+	sample(0, dv, dw, vwpp);
+	sample(0, dv, -dw, vwpm);
+	sample(0, -dv, dw, vwmp);
+	sample(0, -dv, -dw, vwmm);
+	sample(du, dv, dw, uvwppp);
+	sample(du, -dv, dw, uvwpmp);
+	sample(-du, dv, dw, uvwmpp);
+	sample(-du, -dv, dw, uvwmmp);
+	sample(du, dv, -dw, uvwppm);
+	sample(du, -dv, -dw, uvwpmm);
+	sample(-du, dv, -dw, uvwmpm);
+	sample(-du, -dv, -dw, uvwmmm);
+	for (int axis = 0; axis < 3; axis++) {
+		double *c = mCoeff[axis];
+		c[kTermConst] = f0[axis];
+		c[kTermU] = (up[axis] - um[axis]) / (2.0 * du);
+		c[kTermV] = (vp[axis] - vm[axis]) / (2.0 * dv);
+		c[kTermW] = (wp[axis] - wm[axis]) / (2.0 * dw);
+		c[kTermUU] = (up[axis] - 2.0 * f0[axis] + um[axis]) / (2.0 * du * du);
+		c[kTermVV] = (vp[axis] - 2.0 * f0[axis] + vm[axis]) / (2.0 * dv * dv);
+		c[kTermWW] = (wp[axis] - 2.0 * f0[axis] + wm[axis]) / (2.0 * dw * dw);
+		c[kTermUV] = (uvpp[axis] - uvpm[axis] - uvmp[axis] + uvmm[axis]) / (4.0 * du * dv);
+		c[kTermUW] = (uwpp[axis] - uwpm[axis] - uwmp[axis] + uwmm[axis]) / (4.0 * du * dw);
+		c[kTermVW] = (vwpp[axis] - vwpm[axis] - vwmp[axis] + vwmm[axis]) / (4.0 * dv * dw);
+		// and how the second order terms change with elevation.
+		const double uuAbove = uwpp[axis] - 2.0 * wp[axis] + uwmp[axis];
+		const double uuBelow = uwpm[axis] - 2.0 * wm[axis] + uwmm[axis];
+		c[kTermUUW] = (uuAbove - uuBelow) / (4.0 * du * du * dw);
+		const double vvAbove = vwpp[axis] - 2.0 * wp[axis] + vwmp[axis];
+		const double vvBelow = vwpm[axis] - 2.0 * wm[axis] + vwmm[axis];
+		c[kTermVVW] = (vvAbove - vvBelow) / (4.0 * dv * dv * dw);
+		const double uvAbove = uvwppp[axis] - uvwpmp[axis] - uvwmpp[axis] + uvwmmp[axis];
+		const double uvBelow = uvwppm[axis] - uvwpmm[axis] - uvwmpm[axis] + uvwmmm[axis];
+		c[kTermUVW] = (uvAbove - uvBelow) / (8.0 * du * dv * dw);
+	}
+
+	// use the widest region the expansion is accurate enough over.
+	for (double radius = kMaxRadius; radius >= kMinRadius; radius /= 2.0) {
+		if (isAccurate(radius)) {
+			mRadius = radius;
+			break;
+		}
+	}
+}
+
+void
+LocalTransform::update(double cameraX, double cameraY, double cameraZ)
+{
+	if (mAnchored) {
+		// the anchor's local position moves if the sim has moved its local
+		// origin, which invalidates the whole expansion.
+		double anchor[3];
+		sample(0, 0, 0, anchor);
+		if (anchor[0] == mAnchorLocal[0] && anchor[1] == mAnchorLocal[1] && anchor[2] == mAnchorLocal[2]) {
+			const double dx = cameraX - anchor[0];
+			const double dz = cameraZ - anchor[2];
+			const double limit = std::max(mRadius, kMinRadius) * kMetersPerDegree / 4.0;
+			if (dx * dx + dz * dz <= limit * limit) {
+				return;
+			}
+		} else {
+			++mOriginEpoch;
+		}
+	}
+	double lat, lon, elevation;
+	XPLMLocalToWorld(cameraX, cameraY, cameraZ, &lat, &lon, &elevation);
+	refit(lat, lon, elevation);
+}
+
+void
+LocalTransform::toLocal(size_t count, const XPMPPlanePosition_t *positions, double *x, double *y, double *z)
+{
+	mExact.resize(count);
+	const double *cx = mCoeff[0];
+	const double *cy = mCoeff[1];
+	const double *cz = mCoeff[2];
+	for (size_t i = 0; i < count; ++i) {
+		const double elevation = positions[i].elevation * kFtToMeters;
+		const double u = positions[i].lat - mLat;
+		const double v = wrapLongitude(positions[i].lon - mLon) * mLonScale;
+		const double w = elevation - mElevation;
+		const double uu = u * u, vv = v * v, ww = w * w, uv = u * v, uw = u * w, vw = v * w;
+		x[i] = cx[kTermConst] + cx[kTermU] * u + cx[kTermV] * v + cx[kTermW] * w
+			+ cx[kTermUU] * uu + cx[kTermVV] * vv + cx[kTermWW] * ww
+			+ cx[kTermUV] * uv + cx[kTermUW] * uw + cx[kTermVW] * vw
+			+ (cx[kTermUUW] * uu + cx[kTermVVW] * vv + cx[kTermUVW] * uv) * w;
+		y[i] = cy[kTermConst] + cy[kTermU] * u + cy[kTermV] * v + cy[kTermW] * w
+			+ cy[kTermUU] * uu + cy[kTermVV] * vv + cy[kTermWW] * ww
+			+ cy[kTermUV] * uv + cy[kTermUW] * uw + cy[kTermVW] * vw
+			+ (cy[kTermUUW] * uu + cy[kTermVVW] * vv + cy[kTermUVW] * uv) * w;
+		z[i] = cz[kTermConst] + cz[kTermU] * u + cz[kTermV] * v + cz[kTermW] * w
+			+ cz[kTermUU] * uu + cz[kTermVV] * vv + cz[kTermWW] * ww
+			+ cz[kTermUV] * uv + cz[kTermUW] * uw + cz[kTermVW] * vw
+			+ (cz[kTermUUW] * uu + cz[kTermVVW] * vv + cz[kTermUVW] * uv) * w;
+		mExact[i] = (std::fabs(u) > mRadius) | (std::fabs(v) > mRadius)
+			| (elevation < kMinElevation) | (elevation > kMaxElevation);
+	}
+	for (size_t i = 0; i < count; ++i) {
+		if (mExact[i]) {
+			XPLMWorldToLocal(positions[i].lat, positions[i].lon, positions[i].elevation * kFtToMeters, &x[i], &y[i], &z[i]);
+		}
+	}
+}
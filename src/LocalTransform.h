@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef LOCALTRANSFORM_H
+#define LOCALTRANSFORM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "XPMPMultiplayer.h"
+
+/** LocalTransform converts plane positions into local OpenGL coordinates in
+ * bulk, without calling into the sim for every plane.
+ *
+ * It keeps a second order expansion of XPLMWorldToLocal about an anchor
+ * point near the camera.  The expansion is measured from the SDK itself
+ * (so it makes no assumptions about the sim's earth model) whenever the
+ * camera moves too far from the anchor or the sim moves its local origin,
+ * and it's checked against the SDK across the region it'll be used in
+ * before it's trusted.  Planes outside that region fall back to
+ * XPLMWorldToLocal.
+ */
+class LocalTransform {
+public:
+	/** the largest error we accept from the expansion, either in metres or
+	 * relative to the distance from the anchor, whichever is larger.  The
+	 * relative error is well under a pixel at any sensible field of view.
+	 */
+	static constexpr double	kMaxError = 0.1;
+	static constexpr double	kMaxRelativeError = 2e-5;
+	/** the largest and smallest half-widths (in degrees of arc) of the
+	 * region we'll try to use the expansion in
+	 */
+	static constexpr double	kMaxRadius = 0.25;
+	static constexpr double	kMinRadius = 0.02;
+	/** the elevations (in metres) the expansion is checked between */
+	static constexpr double	kMinElevation = -500.0;
+	static constexpr double	kMaxElevation = 20000.0;
+
+	LocalTransform();
+
+	/** update re-anchors the expansion if it's needed.  It must be called
+	 * once per frame, before toLocal.
+	 *
+	 * @param cameraX
+	 * @param cameraY
+	 * @param cameraZ the camera's position in local coordinates
+	 */
+	void update(double cameraX, double cameraY, double cameraZ);
+
+	/** toLocal converts count plane positions into local coordinates. */
+	void toLocal(size_t count, const XPMPPlanePosition_t *positions, double *x, double *y, double *z);
+
+	/** originEpoch changes whenever update sees that the sim has moved its
+	 * local origin, so anything cached in local coordinates can tell it's
+	 * stale.
+	 */
+	uint32_t originEpoch() const
+	{
+		return mOriginEpoch;
+	}
+
+private:
+	// the terms of the expansion, in u (degrees of latitude), v (degrees of
+	// longitude scaled to arc) and w (metres of elevation).  It's quadratic
+	// in u and v, with the quadratic's terms linear in w so that the
+	// expansion holds from the ground to the flight levels.
+	enum {
+		kTermConst = 0,
+		kTermU,
+		kTermV,
+		kTermW,
+		kTermUU,
+		kTermVV,
+		kTermWW,
+		kTermUV,
+		kTermUW,
+		kTermVW,
+		kTermUUW,
+		kTermVVW,
+		kTermUVW,
+		kTermCount
+	};
+
+	void refit(double lat, double lon, double elevation);
+	void sample(double u, double v, double w, double out[3]) const;
+	void evaluate(double u, double v, double w, double out[3]) const;
+	bool isAccurate(double radius) const;
+
+	double		mLat;
+	double		mLon;
+	double		mElevation;
+	double		mLonScale;
+	/** the half-width of the region the expansion is good for, or less than
+	 * 0 if it's not usable at all.
+	 */
+	double		mRadius;
+	double		mCoeff[3][kTermCount];
+	double		mAnchorLocal[3];	// the anchor in local coordinates when fitted
+	bool		mAnchored;
+	uint32_t	mOriginEpoch;
+
+	std::vector<uint8_t>	mExact;
+};
+
+#endif //LOCALTRANSFORM_H
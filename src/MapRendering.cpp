@@ -134,15 +134,16 @@ XPMPMapRendering::IconCallback(XPLMMapLayerID inLayer,
 
     float mapX, mapY;
 
-    for (const auto &aircraftPair: gPlanes) {
+    for (size_t i = 0; i < gPlanes.size(); ++i) {
+        const XPMPPlanePosition_t &position = gPlanes.position(i);
         XPLMMapProject(projection,
-                       aircraftPair.second->mPosition.lat,
-                       aircraftPair.second->mPosition.lon,
+                       position.lat,
+                       position.lon,
                        &mapX,
                        &mapY);
 
         float iconRotation = XPLMMapGetNorthHeading(projection, mapX, mapY) +
-                             aircraftPair.second->mPosition.heading;
+                             position.heading;
         iconRotation = fmod(iconRotation, 360.0f);
         XPLMDrawMapIconFromSheet(inLayer,
                                  gMapSheetPath.c_str(),
@@ -182,14 +183,15 @@ XPMPMapRendering::LabelCallback(XPLMMapLayerID inLayer,
         offsetY = static_cast<float>(cos(rotation) * linearOffset);
     }
 
-    for (const auto &aircraftPair: gPlanes) {
+    for (size_t i = 0; i < gPlanes.size(); ++i) {
+        const XPMPPlanePosition_t &position = gPlanes.position(i);
         XPLMMapProject(projection,
-                       aircraftPair.second->mPosition.lat,
-                       aircraftPair.second->mPosition.lon,
+                       position.lat,
+                       position.lon,
                        &mapX,
                        &mapY);
         XPLMDrawMapLabel(inLayer,
-                         aircraftPair.second->mPosition.label,
+                         position.label,
                          mapX + offsetX,
                          mapY + offsetY,
                          xplm_MapOrientation_UI,
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "MotionEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const double	kEarthRadius = 6371000.0;		// metres
+static const double	kMetresPerDegLat = kEarthRadius * M_PI / 180.0;
+static const double	kFeetPerMetre = 1.0 / 0.3048;
+
+/** WrapDegrees brings a difference in angle back into [-180, 180). */
+static double
+WrapDegrees(double angle)
+{
+	return angle - 360.0 * std::floor((angle + 180.0) / 360.0);
+}
+
+void
+MotionEngine::push_back()
+{
+	mActive.push_back(0);
+	mFixTime.push_back(0.0);
+	mBlendStart.push_back(0.0);
+	for (int c = 0; c < Channel_Count; ++c) {
+		mBase[c].push_back(0.0);
+		mRate[c].push_back(0.0);
+		mError[c].push_back(0.0);
+	}
+}
+
+void
+MotionEngine::moveLast(size_t index)
+{
+	const size_t last = mActive.size() - 1;
+	mActive[index] = mActive[last];
+	mFixTime[index] = mFixTime[last];
+	mBlendStart[index] = mBlendStart[last];
+	for (int c = 0; c < Channel_Count; ++c) {
+		mBase[c][index] = mBase[c][last];
+		mRate[c][index] = mRate[c][last];
+		mError[c][index] = mError[c][last];
+	}
+}
+
+void
+MotionEngine::pop_back()
+{
+	mActive.pop_back();
+	mFixTime.pop_back();
+	mBlendStart.pop_back();
+	for (int c = 0; c < Channel_Count; ++c) {
+		mBase[c].pop_back();
+		mRate[c].pop_back();
+		mError[c].pop_back();
+	}
+}
+
+void
+MotionEngine::clear()
+{
+	mActive.clear();
+	mFixTime.clear();
+	mBlendStart.clear();
+	for (int c = 0; c < Channel_Count; ++c) {
+		mBase[c].clear();
+		mRate[c].clear();
+		mError[c].clear();
+	}
+}
+
+void
+MotionEngine::reserve(size_t count)
+{
+	mActive.reserve(count);
+	mFixTime.reserve(count);
+	mBlendStart.reserve(count);
+	for (int c = 0; c < Channel_Count; ++c) {
+		mBase[c].reserve(count);
+		mRate[c].reserve(count);
+		mError[c].reserve(count);
+	}
+}
+
+void
+MotionEngine::setFix(size_t index, const XPMPPlaneFix_t &fix, double now)
+{
+	// work out where we're drawing the plane right now, so we can blend from
+	// there to the new track.
+	double current[Channel_Count];
+	const bool wasActive = mActive[index] != 0;
+	if (wasActive) {
+		const double dt = std::min(std::max(now - mFixTime[index], 0.0), kMaxExtrapolation);
+		const double blend = std::max(1.0 - (now - mBlendStart[index]) / kBlendTime, 0.0);
+		for (int c = 0; c < Channel_Count; ++c) {
+			current[c] = mBase[c][index] + mRate[c][index] * dt + mError[c][index] * blend;
+		}
+	}
+
+	const double cosLat = std::max(std::cos(fix.lat * M_PI / 180.0), 1e-6);
+	mBase[Channel_Lat][index] = fix.lat;
+	mBase[Channel_Lon][index] = fix.lon;
+	mBase[Channel_Elevation][index] = fix.elevation;
+	mBase[Channel_Pitch][index] = fix.pitch;
+	mBase[Channel_Roll][index] = fix.roll;
+	mBase[Channel_Heading][index] = fix.heading;
+	mRate[Channel_Lat][index] = fix.velocityNorth / kMetresPerDegLat;
+	mRate[Channel_Lon][index] = fix.velocityEast / (kMetresPerDegLat * cosLat);
+	mRate[Channel_Elevation][index] = fix.velocityUp * kFeetPerMetre;
+	mRate[Channel_Pitch][index] = fix.pitchRate;
+	mRate[Channel_Roll][index] = fix.rollRate;
+	mRate[Channel_Heading][index] = fix.headingRate;
+
+	const double age = std::max(fix.age, 0.0);
+	mFixTime[index] = now - age;
+	mBlendStart[index] = now;
+
+	const double dt = std::min(age, kMaxExtrapolation);
+	for (int c = 0; c < Channel_Count; ++c) {
+		double error = 0.0;
+		if (wasActive) {
+			error = current[c] - (mBase[c][index] + mRate[c][index] * dt);
+			if (c == Channel_Heading || c == Channel_Roll || c == Channel_Lon) {
+				error = WrapDegrees(error);
+			}
+		}
+		mError[c][index] = error;
+	}
+	mActive[index] = 1;
+}
+
+void
+MotionEngine::advance(double now, XPMPPlanePosition_t *positions)
+{
+	const size_t count = mActive.size();
+	if (count == 0) {
+		return;
+	}
+	mDt.resize(count);
+	mBlend.resize(count);
+	for (int c = 0; c < Channel_Count; ++c) {
+		mOut[c].resize(count);
+	}
+
+	// the kernel runs over every plane - it's cheaper to compute the idle ones
+	// than to branch around them.
+	const double *fixTime = mFixTime.data();
+	const double *blendStart = mBlendStart.data();
+	double *dt = mDt.data();
+	double *blend = mBlend.data();
+	for (size_t i = 0; i < count; ++i) {
+		dt[i] = std::min(std::max(now - fixTime[i], 0.0), kMaxExtrapolation);
+		blend[i] = std::max(1.0 - (now - blendStart[i]) * (1.0 / kBlendTime), 0.0);
+	}
+	for (int c = 0; c < Channel_Count; ++c) {
+		const double *base = mBase[c].data();
+		const double *rate = mRate[c].data();
+		const double *error = mError[c].data();
+		double *out = mOut[c].data();
+		for (size_t i = 0; i < count; ++i) {
+			out[i] = base[i] + rate[i] * dt[i] + error[i] * blend[i];
+		}
+	}
+	double *heading = mOut[Channel_Heading].data();
+	for (size_t i = 0; i < count; ++i) {
+		heading[i] -= 360.0 * std::floor(heading[i] * (1.0 / 360.0));
+	}
+	double *lon = mOut[Channel_Lon].data();
+	for (size_t i = 0; i < count; ++i) {
+		lon[i] -= 360.0 * std::floor((lon[i] + 180.0) * (1.0 / 360.0));
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		if (!mActive[i]) {
+			continue;
+		}
+		XPMPPlanePosition_t &position = positions[i];
+		position.lat = mOut[Channel_Lat][i];
+		position.lon = mOut[Channel_Lon][i];
+		position.elevation = mOut[Channel_Elevation][i];
+		position.pitch = static_cast<float>(mOut[Channel_Pitch][i]);
+		position.roll = static_cast<float>(mOut[Channel_Roll][i]);
+		position.heading = static_cast<float>(mOut[Channel_Heading][i]);
+	}
+}
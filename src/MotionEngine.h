@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef MOTIONENGINE_H
+#define MOTIONENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "XPMPMultiplayer.h"
+
+/** MotionEngine dead-reckons the planes the client has handed fixes to.
+ *
+ * Its state is kept as parallel arrays indexed by the plane's dense index in
+ * the PlaneStore, which is responsible for keeping them in step as planes are
+ * added and removed.  Each frame advance() runs a branch-free kernel over all
+ * of the planes, so the compiler can vectorise it, and then copies the
+ * results into the positions of the planes it's driving.
+ *
+ * When a new fix arrives for a plane that's already being driven, the gap
+ * between where the plane was drawn and where the fix says it is gets
+ * recorded as an error term, which is blended out over kBlendTime.
+ */
+class MotionEngine {
+public:
+	/** how long to keep extrapolating a fix before freezing the plane */
+	static constexpr double	kMaxExtrapolation = 15.0;
+	/** how long to take blending out the error when a new fix arrives */
+	static constexpr double	kBlendTime = 1.0;
+
+	/** push_back adds state for a new plane, which isn't being driven. */
+	void push_back();
+	/** moveLast replaces the state at index with the last plane's. */
+	void moveLast(size_t index);
+	void pop_back();
+	void clear();
+	void reserve(size_t count);
+
+	/** setFix starts or continues driving the plane at index from fix.
+	 *
+	 * @param now the current time in seconds, from XPLMGetElapsedTime.
+	 */
+	void setFix(size_t index, const XPMPPlaneFix_t &fix, double now);
+
+	/** release stops driving the plane at index. */
+	void release(size_t index)
+	{
+		mActive[index] = 0;
+	}
+
+	/** advance extrapolates every plane being driven to now, and writes the
+	 * results into the matching entries in positions.
+	 */
+	void advance(double now, XPMPPlanePosition_t *positions);
+
+private:
+	enum {
+		Channel_Lat = 0,
+		Channel_Lon,
+		Channel_Elevation,
+		Channel_Pitch,
+		Channel_Roll,
+		Channel_Heading,
+		Channel_Count
+	};
+
+	std::vector<uint8_t>	mActive;
+	std::vector<double>		mFixTime;		// when the fix was taken
+	std::vector<double>		mBlendStart;	// when the fix arrived
+
+	// for each channel: the value at mFixTime, its rate of change per second,
+	// and the error to blend out.
+	std::vector<double>		mBase[Channel_Count];
+	std::vector<double>		mRate[Channel_Count];
+	std::vector<double>		mError[Channel_Count];
+
+	// scratch space for advance().
+	std::vector<double>		mDt;
+	std::vector<double>		mBlend;
+	std::vector<double>		mOut[Channel_Count];
+};
+
+#endif //MOTIONENGINE_H
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "PlaneStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+PlaneStore::Handle
+PlaneStore::add(XPMPPlane &&plane)
+{
+	uint32_t slot;
+	if (!mFreeSlots.empty()) {
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	} else if (mSlots.size() < kMaxSlots) {
+		slot = static_cast<uint32_t>(mSlots.size());
+		mSlots.push_back(Slot{0, 1});
+	} else {
+		return kInvalidHandle;
+	}
+	const Handle handle = (mSlots[slot].generation << kSlotBits) | slot;
+
+	mSlots[slot].index = static_cast<uint32_t>(mPlanes.size());
+	mPositions.push_back(XPMPPlanePosition_t{});
+	mSurfaces.push_back(XPMPPlaneSurfaces_t{});
+	mSurveillance.push_back(XPMPPlaneSurveillance_t{});
+	mDistanceSqr.push_back(0.0f);
+	mCulled.push_back(0);
+	mInFrustum.push_back(0);
+	mPlanes.push_back(std::move(plane));
+	mHandles.push_back(handle);
+	mMotion.push_back();
+	mTerrain.push_back();
+	mScheduler.push_back();
+	return handle;
+}
+
+void
+PlaneStore::retireSlot(uint32_t slot)
+{
+	// bumping the generation invalidates every handle issued for the slot.
+	mSlots[slot].generation = (mSlots[slot].generation + 1) & kGenerationMask;
+	if (mSlots[slot].generation == 0) {
+		mSlots[slot].generation = 1;
+	}
+	mFreeSlots.push_back(slot);
+}
+
+void
+PlaneStore::remove(size_t index)
+{
+	const size_t last = mPlanes.size() - 1;
+	retireSlot(mHandles[index] & kSlotMask);
+	if (index != last) {
+		mPositions[index] = mPositions[last];
+		mSurfaces[index] = mSurfaces[last];
+		mSurveillance[index] = mSurveillance[last];
+		mDistanceSqr[index] = mDistanceSqr[last];
+		mCulled[index] = mCulled[last];
+		mInFrustum[index] = mInFrustum[last];
+		mPlanes[index] = std::move(mPlanes[last]);
+		mHandles[index] = mHandles[last];
+		mSlots[mHandles[index] & kSlotMask].index = static_cast<uint32_t>(index);
+		mMotion.moveLast(index);
+		mTerrain.moveLast(index);
+		mScheduler.moveLast(index);
+	}
+	mPositions.pop_back();
+	mSurfaces.pop_back();
+	mSurveillance.pop_back();
+	mDistanceSqr.pop_back();
+	mCulled.pop_back();
+	mInFrustum.pop_back();
+	mPlanes.pop_back();
+	mHandles.pop_back();
+	mMotion.pop_back();
+	mTerrain.pop_back();
+	mScheduler.pop_back();
+}
+
+void
+PlaneStore::clear()
+{
+	mPositions.clear();
+	mSurfaces.clear();
+	mSurveillance.clear();
+	mDistanceSqr.clear();
+	mCulled.clear();
+	mInFrustum.clear();
+	mPlanes.clear();
+	// keep the slots (and their generations) so that no handle issued before
+	// the clear can alias a plane created after it.
+	for (const auto handle: mHandles) {
+		retireSlot(handle & kSlotMask);
+	}
+	mHandles.clear();
+	mMotion.clear();
+	mTerrain.clear();
+	mScheduler.clear();
+}
+
+void
+PlaneStore::reserve(size_t count)
+{
+	mPositions.reserve(count);
+	mSurfaces.reserve(count);
+	mSurveillance.reserve(count);
+	mDistanceSqr.reserve(count);
+	mCulled.reserve(count);
+	mInFrustum.reserve(count);
+	mPlanes.reserve(count);
+	mHandles.reserve(count);
+	mSlots.reserve(count);
+	mMotion.reserve(count);
+	mTerrain.reserve(count);
+	mScheduler.reserve(count);
+}
+
+void
+PlaneStore::updatePosition(size_t index, const XPMPPlanePosition_t &newPosition)
+{
+	memcpy(&mPositions[index], &newPosition, std::min(newPosition.size, sizeof(XPMPPlanePosition_t)));
+	mMotion.release(index);
+}
+
+void
+PlaneStore::updateSurfaces(size_t index, const XPMPPlaneSurfaces_t &newSurfaces)
+{
+	memcpy(&mSurfaces[index], &newSurfaces, std::min(newSurfaces.size, sizeof(XPMPPlaneSurfaces_t)));
+}
+
+void
+PlaneStore::updateSurveillance(size_t index, const XPMPPlaneSurveillance_t &newSurveillance)
+{
+	memcpy(&mSurveillance[index], &newSurveillance, std::min(newSurveillance.size, sizeof(XPMPPlaneSurveillance_t)));
+}
+
+void
+PlaneStore::updateInstances(const FrameContext &frame)
+{
+	const size_t count = mPlanes.size();
+	mLocalX.resize(count);
+	mLocalY.resize(count);
+	mLocalZ.resize(count);
+	mCullX.resize(count);
+	mCullY.resize(count);
+	mCullZ.resize(count);
+	mCullRadius.resize(count);
+	mPlaced.resize(count);
+	mVisible.resize(count);
+	gInstanceUpdateStats.lastFramePushed = 0;
+	gInstanceUpdateStats.lastFrameSkipped = 0;
+	if (count == 0) {
+		return;
+	}
+
+	mLocalTransform.update(frame.cameraX, frame.cameraY, frame.cameraZ);
+	mLocalTransform.toLocal(count, mPositions.data(), mLocalX.data(), mLocalY.data(), mLocalZ.data());
+
+	mTerrain.beginFrame(mLocalTransform.originEpoch());
+	const bool clamping = gConfiguration.enableSurfaceClamping;
+	const float guardBand = std::max(gConfiguration.offscreen.guardBand, 0.0f);
+	for (size_t i = 0; i < count; ++i) {
+		TerrainCache *terrain = (clamping && mPositions[i].clampToGround) ? &mTerrain : nullptr;
+		mPlaced[i] = mPlanes[i].placeInstance(mPositions[i], mLocalX[i], mLocalY[i], mLocalZ[i], terrain, i) ? 1 : 0;
+		if (!mPlaced[i]) {
+			mLocalX[i] = mLocalY[i] = mLocalZ[i] = 0.0;
+		}
+		mCullX[i] = static_cast<float>(mLocalX[i]);
+		mCullY[i] = static_cast<float>(mLocalY[i]);
+		mCullZ[i] = static_cast<float>(mLocalZ[i]);
+		mCullRadius[i] = mPlanes[i].getBoundingRadius() + guardBand;
+	}
+
+	frame.camera.SpheresVisible(count,
+		mCullX.data(), mCullY.data(), mCullZ.data(), mCullRadius.data(),
+		mInFrustum.data(), mDistanceSqr.data());
+
+	for (size_t i = 0; i < count; ++i) {
+		XPMPPlane &plane = mPlanes[i];
+		if (!mPlaced[i]) {
+			mDistanceSqr[i] = 0.0f;
+			mCulled[i] = 1;
+			mVisible[i] = 0;
+			continue;
+		}
+		plane.updateInstanceState(frame, mLocalX[i], mLocalY[i], mLocalZ[i], mDistanceSqr[i],
+			mPositions[i], mSurveillance[i]);
+		mCulled[i] = plane.mInstanceData->mCulled ? 1 : 0;
+		mVisible[i] = (mInFrustum[i] && !mCulled[i]) ? 1 : 0;
+	}
+
+	// refresh the instances the scheduler picks, for as long as the budget
+	// allows once the mandatory ones are done.
+	mScheduler.plan(count, mPlaced.data(), mInFrustum.data(), mVisible.data(), mDistanceSqr.data());
+	for (uint32_t i: mScheduler.parking()) {
+		mPlanes[i].parkInstance();
+	}
+	const std::vector<uint32_t> &queue = mScheduler.queue();
+	const double budget = gConfiguration.scheduler.frameBudget;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t n = 0; n < queue.size(); ++n) {
+		if (n >= mScheduler.mandatory() && budget > 0.0 &&
+			std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() > budget) {
+			break;
+		}
+		const size_t i = queue[n];
+		mPlanes[i].refreshInstance(frame, mLocalX[i], mLocalY[i], mLocalZ[i], mPositions[i], mSurfaces[i]);
+		mScheduler.refreshed(i);
+	}
+}
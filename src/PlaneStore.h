@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef PLANESTORE_H
+#define PLANESTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "XPMPMultiplayer.h"
+#include "XPMPPlane.h"
+#include "FrameContext.h"
+#include "LocalTransform.h"
+#include "MotionEngine.h"
+#include "TerrainCache.h"
+#include "UpdateScheduler.h"
+
+/** PlaneStore holds every plane the client has created.
+ *
+ * The planes are kept densely packed, with the state that's touched every
+ * frame held in parallel arrays so the per-frame passes stream linearly
+ * through memory.  Removing a plane moves the last plane into its place, so a
+ * plane's dense index is only good until the next add or remove.
+ *
+ * Clients refer to planes by handle instead, which is what we hand out as
+ * XPMPPlaneIDs.  A handle is a slot index and the slot's generation packed
+ * into 32 bits (so it fits in an XPMPPlaneID on any platform).  The slot
+ * tracks the plane's current dense index, and its generation is bumped when
+ * the plane is removed, so a stale handle is rejected by a single compare
+ * even once the slot has been reused.
+ */
+class PlaneStore {
+public:
+	typedef uint32_t	Handle;
+
+	static constexpr Handle	kInvalidHandle = 0;
+	static constexpr size_t	kNoIndex = SIZE_MAX;
+
+	static constexpr unsigned	kSlotBits = 18;
+	static constexpr Handle		kSlotMask = (1u << kSlotBits) - 1;
+	static constexpr uint32_t	kMaxSlots = kSlotMask + 1;
+	static constexpr uint32_t	kGenerationMask = UINT32_MAX >> kSlotBits;
+
+	static Handle handleFromID(XPMPPlaneID id)
+	{
+		return static_cast<Handle>(reinterpret_cast<uintptr_t>(id));
+	}
+
+	static XPMPPlaneID idFromHandle(Handle handle)
+	{
+		return reinterpret_cast<XPMPPlaneID>(static_cast<uintptr_t>(handle));
+	}
+
+	/** add moves plane into the store with zeroed state.
+	 *
+	 * @returns the new plane's handle, or kInvalidHandle if every slot is in
+	 *     use.
+	 */
+	Handle add(XPMPPlane &&plane);
+
+	/** remove destroys the plane at the dense index. */
+	void remove(size_t index);
+
+	void clear();
+
+	/** reserve makes room for count planes in total. */
+	void reserve(size_t count);
+
+	/** indexOf finds the current dense index of the plane with handle.
+	 *
+	 * @returns kNoIndex if handle doesn't refer to a live plane.
+	 */
+	size_t indexOf(Handle handle) const
+	{
+		const uint32_t slot = handle & kSlotMask;
+		if (slot >= mSlots.size() || mSlots[slot].generation != (handle >> kSlotBits)) {
+			return kNoIndex;
+		}
+		return mSlots[slot].index;
+	}
+
+	size_t size() const
+	{
+		return mPlanes.size();
+	}
+
+	bool empty() const
+	{
+		return mPlanes.empty();
+	}
+
+	XPMPPlane &plane(size_t index)
+	{
+		return mPlanes[index];
+	}
+
+	const XPMPPlanePosition_t &position(size_t index) const
+	{
+		return mPositions[index];
+	}
+
+	float distanceSqr(size_t index) const
+	{
+		return mDistanceSqr[index];
+	}
+
+	bool isCulled(size_t index) const
+	{
+		return mCulled[index] != 0;
+	}
+
+	/** isInFrustum reports whether any part of the plane, or the offscreen
+	 * guard band around it, was in the view frustum in the last
+	 * updateInstances.
+	 */
+	bool isInFrustum(size_t index) const
+	{
+		return mInFrustum[index] != 0;
+	}
+
+	// the update methods only copy as much of the client's structure as we
+	// know about (or as they do).  Updating the position takes the plane out
+	// of the motion engine.
+	void updatePosition(size_t index, const XPMPPlanePosition_t &newPosition);
+	void updateSurfaces(size_t index, const XPMPPlaneSurfaces_t &newSurfaces);
+	void updateSurveillance(size_t index, const XPMPPlaneSurveillance_t &newSurveillance);
+
+	/** setFix hands the plane at index to the motion engine.
+	 *
+	 * @param now the current time, from XPLMGetElapsedTime.
+	 */
+	void setFix(size_t index, const XPMPPlaneFix_t &fix, double now)
+	{
+		mMotion.setFix(index, fix, now);
+	}
+
+	/** advanceMotion moves the planes driven by the motion engine to their
+	 * positions at now.
+	 */
+	void advanceMotion(double now)
+	{
+		mMotion.advance(now, mPositions.data());
+	}
+
+	/** terrainStats reports the terrain cache's probe counters. */
+	const XPMPTerrainProbeStats_t &terrainStats() const
+	{
+		return mTerrain.stats();
+	}
+
+	/** updateInstances runs the per-frame instance update for every plane and
+	 * records their distances and cull states.
+	 *
+	 * This runs as passes over the store: converting every plane into local
+	 * coordinates, placing them relative to the terrain, culling them all
+	 * against the frustum in one batch, updating each plane's state, then
+	 * refreshing the instances the UpdateScheduler picks.
+	 */
+	void updateInstances(const FrameContext &frame);
+
+private:
+
+	// the dense arrays, all indexed by the plane's dense index.
+	std::vector<XPMPPlanePosition_t>		mPositions;
+	std::vector<XPMPPlaneSurfaces_t>		mSurfaces;
+	std::vector<XPMPPlaneSurveillance_t>	mSurveillance;
+	std::vector<float>						mDistanceSqr;
+	std::vector<uint8_t>					mCulled;
+	std::vector<uint8_t>					mInFrustum;
+	std::vector<XPMPPlane>					mPlanes;
+	std::vector<Handle>						mHandles;
+	MotionEngine							mMotion;
+	TerrainCache							mTerrain;
+	UpdateScheduler							mScheduler;
+	LocalTransform							mLocalTransform;
+
+	// scratch for updateInstances, only valid during the update.
+	std::vector<double>						mLocalX;
+	std::vector<double>						mLocalY;
+	std::vector<double>						mLocalZ;
+	std::vector<float>						mCullX;
+	std::vector<float>						mCullY;
+	std::vector<float>						mCullZ;
+	std::vector<float>						mCullRadius;
+	std::vector<uint8_t>					mPlaced;
+	std::vector<uint8_t>					mVisible;
+
+	void retireSlot(uint32_t slot);
+
+	struct Slot {
+		uint32_t	index;		// the plane's dense index, if live.
+		uint32_t	generation;	// never 0, so no handle is kInvalidHandle
+	};
+
+	std::vector<Slot>						mSlots;
+	std::vector<uint32_t>					mFreeSlots;
+};
+
+#endif //PLANESTORE_H
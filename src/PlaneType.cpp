@@ -29,45 +29,106 @@
 
 using namespace std;
 
-PlaneType::PlaneType(
-	const std::string &icao,
-	const std::string &airline,
-	const std::string &livery) :
-	mICAO(icao),
-	mAirline(airline),
-	mLivery(livery)
+void
+PlaneType::ShortCode::set(std::string_view code)
 {
-
+	memset(chars, 0, kLength);
+	if (code.size() < kLength) {
+		memcpy(chars, code.data(), code.size());
+	} else {
+		const Atom atom = Atom_Find(code);
+		memcpy(chars, &atom, sizeof(atom));
+		chars[kLength - 1] = static_cast<char>(kSpilled);
+	}
 }
 
-PlaneType::PlaneType(const PlaneType &copySrc) :
-	mICAO(copySrc.mICAO),
-	mAirline(copySrc.mAirline),
-	mLivery(copySrc.mLivery)
+std::string_view
+PlaneType::ShortCode::get() const
 {
+	if (static_cast<unsigned char>(chars[kLength - 1]) == kSpilled) {
+		Atom atom;
+		memcpy(&atom, chars, sizeof(atom));
+		return Atom_String(atom);
+	}
+	return std::string_view(chars, strnlen(chars, kLength));
+}
 
+bool
+PlaneType::ShortCode::unknown() const
+{
+	Atom atom;
+	memcpy(&atom, chars, sizeof(atom));
+	return static_cast<unsigned char>(chars[kLength - 1]) == kSpilled && atom == kUnknownAtom;
 }
 
-PlaneType::PlaneType(PlaneType &&moveSrc) :
-	mICAO(std::move(moveSrc.mICAO)),
-	mAirline(std::move(moveSrc.mAirline)),
-	mLivery(std::move(moveSrc.mLivery))
+/** MixHash is the splitmix64 finaliser; it spreads the packed codes across
+ * all of the bits so the hash tables don't have to.
+ */
+static uint64_t
+MixHash(uint64_t h)
 {
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	return h ^ (h >> 31);
+}
 
+PlaneType::PlaneType(
+	std::string_view icao,
+	std::string_view airline,
+	std::string_view livery)
+{
+	mICAO.set(icao);
+	mAirline.set(airline);
+	mLivery = Atom_Find(livery);
+
+	uint64_t h = MixHash(mICAO.packed());
+	h = MixHash(h ^ mAirline.packed());
+	h = MixHash(h ^ mLivery);
+	if (mICAO.unknown() || mAirline.unknown() || mLivery == kUnknownAtom) {
+		auto unknown = std::make_shared<UnknownCodes>();
+		if (mICAO.unknown()) {
+			unknown->icao.assign(icao.data(), icao.size());
+		}
+		if (mAirline.unknown()) {
+			unknown->airline.assign(airline.data(), airline.size());
+		}
+		if (mLivery == kUnknownAtom) {
+			unknown->livery.assign(livery.data(), livery.size());
+		}
+		const std::hash<std::string> hashText;
+		h = MixHash(h ^ hashText(unknown->icao));
+		h = MixHash(h ^ hashText(unknown->airline));
+		h = MixHash(h ^ hashText(unknown->livery));
+		mUnknown = std::move(unknown);
+	}
+	mHash = static_cast<size_t>(h);
 }
 
 bool
 PlaneType::compare(const PlaneType &other, PlaneTypeMask mask) const
 {
-	bool 	matches = true;
-
+	if (mask == Mask_All) {
+		// equal codes are unknown in both or neither, so if there's any
+		// unknown text, both sides have it.
+		return mHash == other.mHash &&
+			mICAO.packed() == other.mICAO.packed() &&
+			mAirline.packed() == other.mAirline.packed() &&
+			mLivery == other.mLivery &&
+			(!mUnknown || mUnknown == other.mUnknown || *mUnknown == *other.mUnknown);
+	}
 	if (mask & Mask_ICAO) {
-		if (other.mICAO != mICAO) {
+		if (other.mICAO.packed() != mICAO.packed()) {
+			return false;
+		}
+		if (mICAO.unknown() && mUnknown->icao != other.mUnknown->icao) {
 			return false;
 		}
 	}
 	if (mask & Mask_Airline) {
-		if (other.mAirline != mAirline) {
+		if (other.mAirline.packed() != mAirline.packed()) {
+			return false;
+		}
+		if (mAirline.unknown() && mUnknown->airline != other.mUnknown->airline) {
 			return false;
 		}
 	}
@@ -75,6 +136,9 @@ PlaneType::compare(const PlaneType &other, PlaneTypeMask mask) const
 		if (other.mLivery != mLivery) {
 			return false;
 		}
+		if (mLivery == kUnknownAtom && mUnknown->livery != other.mUnknown->livery) {
+			return false;
+		}
 	}
 	return true;
 }
@@ -91,31 +155,55 @@ PlaneType::operator!=(const PlaneType &other) const
 	return !compare(other, Mask_All);
 }
 
-void
-PlaneType::operator=(const PlaneType &other)
+std::string_view
+PlaneType::getICAO() const
 {
-	mICAO = other.mICAO;
-	mAirline = other.mAirline;
-	mLivery = other.mLivery;
+	if (mICAO.unknown()) {
+		return mUnknown->icao;
+	}
+	return mICAO.get();
 }
 
+std::string_view
+PlaneType::getAirline() const
+{
+	if (mAirline.unknown()) {
+		return mUnknown->airline;
+	}
+	return mAirline.get();
+}
+
+const std::string &
+PlaneType::getLivery() const
+{
+	if (mLivery == kUnknownAtom) {
+		return mUnknown->livery;
+	}
+	return Atom_String(mLivery);
+}
 
 string
 PlaneType::toLongString() const
 {
+	const std::string_view icao = getICAO();
+	const std::string_view airline = getAirline();
+	const std::string &livery = getLivery();
+
 	string rv = "";
-	if (!mICAO.empty()) {
-		rv += "ICAO=" + mICAO;
+	if (!icao.empty()) {
+		rv += "ICAO=";
+		rv += icao;
 	}
-	if (!mAirline.empty()) {
+	if (!airline.empty()) {
 		if (!rv.empty())
 			rv += " ";
-		rv += "AIRLINE=" + mAirline;
+		rv += "AIRLINE=";
+		rv += airline;
 	}
-	if (!mLivery.empty()) {
+	if (!livery.empty()) {
 		if (!rv.empty())
 			rv += " ";
-		rv += "LIVERY=" + mLivery;
+		rv += "LIVERY=" + livery;
 	}
 	if (rv.empty()) {
 		rv = "-NILTYPE-";
@@ -126,6 +214,11 @@ PlaneType::toLongString() const
 string
 PlaneType::toString() const
 {
-	return mICAO + "/" + mAirline + "/" + mLivery;
+	string rv(getICAO());
+	rv += "/";
+	rv += getAirline();
+	rv += "/";
+	rv += getLivery();
+	return rv;
 }
 
@@ -25,6 +25,15 @@
 #ifndef PLANETYPE_H
 #define PLANETYPE_H
 
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "StringAtoms.h"
+
 typedef unsigned short PlaneTypeMask;
 
 const PlaneTypeMask		Mask_ICAO = 	1 << 0;
@@ -32,16 +41,24 @@ const PlaneTypeMask		Mask_Airline =	1 << 1;
 const PlaneTypeMask		Mask_Livery = 	1 << 2;
 const PlaneTypeMask		Mask_All =		Mask_ICAO|Mask_Airline|Mask_Livery;
 
+/** PlaneType is the ICAO/airline/livery triple used to match a plane to a
+ * CSL model.
+ *
+ * It's copied and compared a lot, so it's kept small, and allocation free
+ * for the codes the CSL library uses: the ICAO and airline codes are held
+ * inline, the livery is held as an atom, and the hash is computed once on
+ * construction.
+ *
+ * Types are built from client input, so the livery is only looked up in the
+ * atom table, never added to it.  A livery the CSL library doesn't know can't
+ * match a model, so it's held as kUnknownAtom, and its text is kept alongside
+ * in a shared block that's only allocated for such types.  The text still
+ * takes part in the hash and comparisons, and reads back unchanged.
+ */
 class PlaneType
 {
 public:
-	std::string	mICAO;
-	std::string	mAirline;
-	std::string	mLivery;
-
-	PlaneType(const std::string &icao="", const std::string &airline="", const std::string &livery="");
-	PlaneType(const PlaneType &copySrc);
-	PlaneType(PlaneType &&moveSrc);
+	PlaneType(std::string_view icao="", std::string_view airline="", std::string_view livery="");
 
 	/* compare checks if the two types match
 	 * @param other The other PlaneType to compare with
@@ -50,12 +67,81 @@ public:
 	bool compare(const PlaneType &other, PlaneTypeMask mask=Mask_ICAO|Mask_Airline|Mask_Livery) const;
 	bool operator==(const PlaneType &other) const;
 	bool operator!=(const PlaneType &other) const;
-	void operator=(const PlaneType &other);
 
+	std::string_view getICAO() const;
+	std::string_view getAirline() const;
+	const std::string &getLivery() const;
+	Atom getLiveryAtom() const
+	{
+		return mLivery;
+	}
+
+	/** hash returns the precomputed hash of the whole type. */
+	size_t hash() const
+	{
+		return mHash;
+	}
 
 	std::string toLongString() const;
 	std::string toString() const;
+
+private:
+	/** ShortCode is a code of up to 7 characters stored inline and NUL padded,
+	 * so that codes compare as a single 64-bit integer.
+	 *
+	 * Longer codes can't be valid ICAO designators, so they're only looked
+	 * up in the atom table: the last byte is set to kSpilled (which a padded
+	 * inline code can never have) and the atom - kUnknownAtom if the CSL
+	 * library never used the code - is stored in the first four bytes.  The
+	 * text of an unknown code is kept in the PlaneType's UnknownCodes.
+	 */
+	struct ShortCode {
+		static const size_t			kLength = 8;
+		static const unsigned char	kSpilled = 0xFF;
+
+		alignas(uint64_t) char	chars[kLength];
+
+		void set(std::string_view code);
+		std::string_view get() const;
+		bool unknown() const;
+		uint64_t packed() const
+		{
+			uint64_t value;
+			memcpy(&value, chars, sizeof(value));
+			return value;
+		}
+	};
+
+	/** UnknownCodes holds the text of the codes the atom table doesn't
+	 * know.  Only those codes are set.
+	 */
+	struct UnknownCodes {
+		std::string	icao;
+		std::string	airline;
+		std::string	livery;
+
+		bool operator==(const UnknownCodes &other) const
+		{
+			return icao == other.icao && airline == other.airline && livery == other.livery;
+		}
+	};
+
+	ShortCode							mICAO;
+	ShortCode							mAirline;
+	Atom								mLivery;
+	size_t								mHash;
+	std::shared_ptr<const UnknownCodes>	mUnknown;	// null unless a code is unknown
 };
 
+namespace std {
+	template<>
+	struct hash<PlaneType> {
+		size_t operator()(const PlaneType &type) const
+		{
+			return type.hash();
+		}
+	};
+}
+
 
 #endif //XSQUAWKBOX_VATSIM_PLANETYPE_H
@@ -24,6 +24,10 @@
 
 #include "Renderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include <XPLMUtilities.h>
 #include <XPLMDisplay.h>
 #include <XPLMProcessing.h>
@@ -32,6 +36,7 @@
 #include "XPMPMultiplayerVars.h"
 #include "MapRendering.h"
 #include "TCASHack.h"
+#include "UpdateQueue.h"
 
 using namespace std;
 
@@ -71,8 +76,6 @@ Renderer_Init()
 #endif
 }
 
-double Render_FullPlaneDistance = 0.0;
-
 void
 Render_PrepLists()
 {
@@ -86,23 +89,39 @@ Render_PrepLists()
 
     TCAS::cleanFrame();
 
+    // apply anything the client's threads have sent since the last frame.
+    gUpdateQueue.drain(gPlanes);
+    gPlanes.advanceMotion(XPLMGetElapsedTime());
+
     if (gPlanes.empty()) {
         return;
     }
 
-    // get our view information
-    CullInfo gl_camera;
+    // read everything the per-plane work needs from the sim, once.
+    FrameContext frame;
     XPLMCameraPosition_t x_camera;
-    XPLMReadCameraPosition(&x_camera);    // only for zoom!
-
-    // Culling - read the camera pos and figure out what's visible.
-    double maxDist = XPLMGetDataf(gVisDataRef);
-    Render_FullPlaneDistance = x_camera.zoom * (5280.0 / 3.2) *
-                               gConfiguration.maxFullAircraftRenderingDistance;    // Only draw planes fully within 3 miles.
-
-    for (auto &planePair: gPlanes) {
-        planePair.second->doInstanceUpdate(gl_camera);
+    XPLMReadCameraPosition(&x_camera);
+    frame.cameraX = x_camera.x;
+    frame.cameraY = x_camera.y;
+    frame.cameraZ = x_camera.z;
+    frame.zoom = x_camera.zoom;
+    frame.visibility = gVisDataRef ? XPLMGetDataf(gVisDataRef) : std::numeric_limits<float>::infinity();
+    frame.fullRenderDistance = gConfiguration.maxFullAircraftRenderingDistance * 1000.0f;
+    frame.lowDetailDistance = std::max(gConfiguration.lod.lowDetailDistance * 1000.0f, frame.fullRenderDistance);
+
+    // planes look bigger when the view is narrower than the reference, so
+    // keep their detail out to proportionally further away.
+    frame.lodScale = 1.0f;
+    if (gConfiguration.lod.referenceFieldOfView > 0.0f) {
+        const float referenceScale = static_cast<float>(1.0 / std::tan(gConfiguration.lod.referenceFieldOfView * 0.5 * M_PI / 180.0));
+        const float scale = frame.camera.ProjectionScale() / referenceScale;
+        if (scale > 1.0f) {
+            frame.lodScale = scale;
+        }
     }
+    frame.ownshipAltitude = XPLMGetDatad(TCAS::gAltitudeRef) / kFtToMeters;
+
+    gPlanes.updateInstances(frame);
 }
 
 
@@ -34,8 +34,6 @@
 extern XPLMDataRef		gVisDataRef;		// Current air visiblity for culling.
 extern XPLMProbeRef		gTerrainProbe;
 
-extern double	Render_FullPlaneDistance;
-
 struct Label {
 	double		x;
 	double		y;
@@ -47,5 +45,11 @@ void	Renderer_Init();
 void	Renderer_Attach_Callbacks();
 void	Renderer_Detach_Callbacks();
 
+/** Render_PrepLists runs the per-frame update for every plane.  It's run
+ * once per frame from the flight loop, and does nothing if it's called
+ * again in the same frame.
+ */
+void	Render_PrepLists();
+
 
 #endif //RENDERER_H
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "StringAtoms.h"
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+// The strings are stored in fixed size chunks which are never moved, so that
+// Atom_String can index them without taking the lock.  Any thread holding an
+// atom got it from Atom_Intern, which already synchronised with the write.
+//
+// The index is only written while the CSL library loads, and is read on
+// every plane create, so lookups share the lock and never wait on each other.
+static const unsigned	kChunkBits = 12;
+static const Atom		kChunkSize = 1u << kChunkBits;
+static const Atom		kMaxChunks = 4096;
+
+static std::shared_mutex						gAtomMutex;
+static std::unordered_map<std::string_view, Atom>	gAtomIndex;	// views into gAtomChunks
+static std::unique_ptr<std::string[]>			gAtomChunks[kMaxChunks];
+static Atom										gNextAtom = kNoAtom + 1;
+
+Atom
+Atom_Intern(std::string_view str)
+{
+	if (str.empty()) {
+		return kNoAtom;
+	}
+
+	// most codes repeat, so try a shared lookup before taking the lock to
+	// add one.
+	{
+		std::shared_lock<std::shared_mutex> lock(gAtomMutex);
+		auto iter = gAtomIndex.find(str);
+		if (iter != gAtomIndex.end()) {
+			return iter->second;
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(gAtomMutex);
+	auto iter = gAtomIndex.find(str);
+	if (iter != gAtomIndex.end()) {
+		return iter->second;
+	}
+
+	const Atom atom = gNextAtom;
+	if ((atom >> kChunkBits) >= kMaxChunks) {
+		throw std::length_error("string atom table is full");
+	}
+	auto &chunk = gAtomChunks[atom >> kChunkBits];
+	if (!chunk) {
+		chunk.reset(new std::string[kChunkSize]);
+	}
+	std::string &slot = chunk[atom & (kChunkSize - 1)];
+	slot.assign(str.data(), str.size());
+	gAtomIndex.emplace(slot, atom);
+	++gNextAtom;
+	return atom;
+}
+
+Atom
+Atom_Find(std::string_view str)
+{
+	if (str.empty()) {
+		return kNoAtom;
+	}
+
+	std::shared_lock<std::shared_mutex> lock(gAtomMutex);
+	auto iter = gAtomIndex.find(str);
+	if (iter == gAtomIndex.end()) {
+		return kUnknownAtom;
+	}
+	return iter->second;
+}
+
+const std::string &
+Atom_String(Atom atom)
+{
+	static const std::string	sEmpty;
+
+	if (atom == kNoAtom || atom == kUnknownAtom) {
+		return sEmpty;
+	}
+	return gAtomChunks[atom >> kChunkBits][atom & (kChunkSize - 1)];
+}
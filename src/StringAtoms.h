@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef STRINGATOMS_H
+#define STRINGATOMS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/** Atom is a handle to a string in the global intern table.
+ *
+ * Equal strings always intern to the same Atom, so codes can be compared and
+ * hashed as plain integers.  Atoms are never released, so the table should
+ * only be fed from the CSL library and data files, not from client input.
+ */
+typedef uint32_t Atom;
+
+/** kNoAtom is the empty string. */
+const Atom kNoAtom = 0;
+
+/** kUnknownAtom is returned by Atom_Find for a string that has never been
+ * interned.  It never compares equal to a real atom.
+ */
+const Atom kUnknownAtom = UINT32_MAX;
+
+/** Atom_Intern returns the Atom for str, adding it to the table if required.
+ * This is safe to call from the loader threads.
+ */
+Atom Atom_Intern(std::string_view str);
+
+/** Atom_Find returns the Atom for str without adding it to the table.
+ * Lookups only take the table's lock shared, so they run alongside each
+ * other and only wait while a CSL library is being loaded.
+ *
+ * @returns kUnknownAtom if str has never been interned.
+ */
+Atom Atom_Find(std::string_view str);
+
+/** Atom_String returns the string an Atom was interned from.  The reference
+ * remains valid for the lifetime of the process.
+ *
+ * @note kUnknownAtom yields the empty string.
+ */
+const std::string &Atom_String(Atom atom);
+
+#endif //STRINGATOMS_H
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "TerrainCache.h"
+
+#include <algorithm>
+
+#include <XPLMScenery.h>
+
+#include "Renderer.h"
+
+// the steepest terrain (as the y component of its normal) we'll extrapolate
+// along.  Anything steeper is treated as flat between probes.
+static const float kMinNormalY = 0.1f;
+
+TerrainCache::TerrainCache() :
+	mFrame(0),
+	mOriginEpoch(0),
+	mStats{}
+{
+	mStats.size = sizeof(mStats);
+}
+
+void
+TerrainCache::push_back()
+{
+	mState.push_back(Probe_None);
+	mProbeX.push_back(0.0);
+	mProbeZ.push_back(0.0);
+	mTerrainY.push_back(0.0);
+	mSlopeX.push_back(0.0f);
+	mSlopeZ.push_back(0.0f);
+}
+
+void
+TerrainCache::moveLast(size_t index)
+{
+	const size_t last = mState.size() - 1;
+	mState[index] = mState[last];
+	mProbeX[index] = mProbeX[last];
+	mProbeZ[index] = mProbeZ[last];
+	mTerrainY[index] = mTerrainY[last];
+	mSlopeX[index] = mSlopeX[last];
+	mSlopeZ[index] = mSlopeZ[last];
+}
+
+void
+TerrainCache::pop_back()
+{
+	mState.pop_back();
+	mProbeX.pop_back();
+	mProbeZ.pop_back();
+	mTerrainY.pop_back();
+	mSlopeX.pop_back();
+	mSlopeZ.pop_back();
+}
+
+void
+TerrainCache::clear()
+{
+	mState.clear();
+	mProbeX.clear();
+	mProbeZ.clear();
+	mTerrainY.clear();
+	mSlopeX.clear();
+	mSlopeZ.clear();
+}
+
+void
+TerrainCache::reserve(size_t count)
+{
+	mState.reserve(count);
+	mProbeX.reserve(count);
+	mProbeZ.reserve(count);
+	mTerrainY.reserve(count);
+	mSlopeX.reserve(count);
+	mSlopeZ.reserve(count);
+}
+
+void
+TerrainCache::beginFrame(uint32_t originEpoch)
+{
+	++mFrame;
+	if (originEpoch != mOriginEpoch) {
+		mOriginEpoch = originEpoch;
+		std::fill(mState.begin(), mState.end(), Probe_None);
+	}
+	mStats.lastFrameProbes = 0;
+	mStats.lastFrameLookups = 0;
+}
+
+bool
+TerrainCache::heightAt(size_t index, double x, double y, double z, double &terrainY)
+{
+	++mStats.lookups;
+	++mStats.lastFrameLookups;
+
+	const double dx = x - mProbeX[index];
+	const double dz = z - mProbeZ[index];
+	const bool moved = (dx * dx + dz * dz) > (kReprobeDistance * kReprobeDistance);
+	const bool refresh = (index % kRefreshFrames) == (mFrame % kRefreshFrames);
+	if (mState[index] != Probe_None && !moved && !refresh) {
+		if (mState[index] == Probe_Missed) {
+			return false;
+		}
+		terrainY = mTerrainY[index] + mSlopeX[index] * dx + mSlopeZ[index] * dz;
+		return true;
+	}
+
+	++mStats.probes;
+	++mStats.lastFrameProbes;
+	XPLMProbeInfo_t	probeResult{};
+	probeResult.structSize = sizeof(probeResult);
+	mProbeX[index] = x;
+	mProbeZ[index] = z;
+	if (XPLMProbeTerrainXYZ(gTerrainProbe, x, y, z, &probeResult) != xplm_ProbeHitTerrain) {
+		mState[index] = Probe_Missed;
+		return false;
+	}
+	mState[index] = Probe_Terrain;
+	mTerrainY[index] = probeResult.locationY;
+	if (probeResult.normalY >= kMinNormalY) {
+		mSlopeX[index] = -probeResult.normalX / probeResult.normalY;
+		mSlopeZ[index] = -probeResult.normalZ / probeResult.normalY;
+	} else {
+		mSlopeX[index] = 0.0f;
+		mSlopeZ[index] = 0.0f;
+	}
+	terrainY = mTerrainY[index];
+	return true;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef TERRAINCACHE_H
+#define TERRAINCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "XPMPMultiplayer.h"
+
+/** TerrainCache remembers the terrain under each plane that's being clamped
+ * to the surface, so we don't have to probe the sim for every plane every
+ * frame.
+ *
+ * Like the MotionEngine, its state is kept as parallel arrays indexed by the
+ * plane's dense index in the PlaneStore, which keeps them in step.
+ *
+ * Each probe records the terrain height and slope at the point it was taken,
+ * and the terrain under a plane that's moved less than kReprobeDistance
+ * since is extrapolated along that slope.  Every plane is also re-probed
+ * once every kRefreshFrames frames regardless, spread round-robin across
+ * the frames, so stationary planes pick up scenery changes without all
+ * probing on the same frame.  Everything is re-probed when the sim moves
+ * its local origin.
+ */
+class TerrainCache {
+public:
+	/** how far (in metres) a plane can move before it's re-probed */
+	static constexpr double		kReprobeDistance = 5.0;
+	/** how often (in frames) every plane is re-probed, even if it's still */
+	static constexpr uint32_t	kRefreshFrames = 60;
+
+	TerrainCache();
+
+	void push_back();
+	/** moveLast replaces the state at index with the last plane's. */
+	void moveLast(size_t index);
+	void pop_back();
+	void clear();
+	void reserve(size_t count);
+
+	/** beginFrame must be called once per frame, before heightAt.
+	 *
+	 * @param originEpoch the LocalTransform's origin epoch, so the cache can
+	 *     be dropped when the local origin moves.
+	 */
+	void beginFrame(uint32_t originEpoch);
+
+	/** heightAt finds the height of the terrain under the plane at index,
+	 * probing the sim if the cached result can't be used.
+	 *
+	 * @param x
+	 * @param y
+	 * @param z the plane's position in local coordinates
+	 * @param terrainY receives the height of the terrain in local coordinates
+	 * @returns false if there's no terrain under the plane.
+	 */
+	bool heightAt(size_t index, double x, double y, double z, double &terrainY);
+
+	const XPMPTerrainProbeStats_t &stats() const
+	{
+		return mStats;
+	}
+
+private:
+	enum : uint8_t {
+		Probe_None = 0,		// never probed, or invalidated
+		Probe_Terrain,		// the probe hit terrain
+		Probe_Missed,		// the probe didn't hit anything
+	};
+
+	std::vector<uint8_t>	mState;
+	std::vector<double>		mProbeX;		// where the last probe was taken
+	std::vector<double>		mProbeZ;
+	std::vector<double>		mTerrainY;		// the terrain height it found
+	std::vector<float>		mSlopeX;		// and the terrain's slope (dy/dx, dy/dz) there
+	std::vector<float>		mSlopeZ;
+
+	uint32_t				mFrame;
+	uint32_t				mOriginEpoch;
+	XPMPTerrainProbeStats_t	mStats;
+};
+
+#endif //TERRAINCACHE_H
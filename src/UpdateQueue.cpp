@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "UpdateQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+UpdateQueue::UpdateQueue() :
+	mHead(nullptr)
+{
+}
+
+UpdateQueue::~UpdateQueue()
+{
+	discard();
+}
+
+void
+UpdateQueue::push(const XPMPUpdate_t *inUpdates, size_t inUpdateSize, size_t inCount)
+{
+	// our default structure is 4 pointers long.
+	if (inUpdateSize < (sizeof(void *) * 4) || inCount == 0) {
+		return;
+	}
+
+	auto *batch = new Batch;
+	batch->updates.reserve(inCount);
+	const auto *ptr = reinterpret_cast<const uint8_t *>(inUpdates);
+	for (size_t idx = 0; idx < inCount; ++idx) {
+		const auto *thisUpdate = reinterpret_cast<const XPMPUpdate_t *>(ptr + (idx * inUpdateSize));
+		if (thisUpdate->plane == nullptr) {
+			continue;
+		}
+
+		batch->updates.emplace_back();
+		QueuedUpdate &queued = batch->updates.back();
+		memset(&queued, 0, sizeof(queued));
+		queued.handle = PlaneStore::handleFromID(thisUpdate->plane);
+		if (thisUpdate->position) {
+			memcpy(&queued.position, thisUpdate->position,
+				std::min(thisUpdate->position->size, sizeof(queued.position)));
+			queued.fields |= Has_Position;
+		}
+		if (thisUpdate->surfaces) {
+			memcpy(&queued.surfaces, thisUpdate->surfaces,
+				std::min(thisUpdate->surfaces->size, sizeof(queued.surfaces)));
+			queued.fields |= Has_Surfaces;
+		}
+		if (thisUpdate->surveillance) {
+			memcpy(&queued.surveillance, thisUpdate->surveillance,
+				std::min(thisUpdate->surveillance->size, sizeof(queued.surveillance)));
+			queued.fields |= Has_Surveillance;
+		}
+	}
+	if (batch->updates.empty()) {
+		delete batch;
+		return;
+	}
+
+	batch->next = mHead.load(std::memory_order_relaxed);
+	while (!mHead.compare_exchange_weak(batch->next, batch,
+		std::memory_order_release, std::memory_order_relaxed)) {
+	}
+}
+
+void
+UpdateQueue::drain(PlaneStore &store)
+{
+	// the consumer always takes the whole stack, so there's no ABA problem.
+	Batch *batch = mHead.exchange(nullptr, std::memory_order_acquire);
+	if (batch == nullptr) {
+		return;
+	}
+
+	// batches come off the stack newest first, and we walk each batch
+	// backwards, so the first update we see for each field is the newest.
+	mApplied.clear();
+	while (batch != nullptr) {
+		for (auto iter = batch->updates.rbegin(); iter != batch->updates.rend(); ++iter) {
+			const size_t index = store.indexOf(iter->handle);
+			if (index == PlaneStore::kNoIndex) {
+				continue;
+			}
+			uint8_t &applied = mApplied[iter->handle];
+			const uint8_t fields = iter->fields & ~applied;
+			if (fields & Has_Position) {
+				store.updatePosition(index, iter->position);
+			}
+			if (fields & Has_Surfaces) {
+				store.updateSurfaces(index, iter->surfaces);
+			}
+			if (fields & Has_Surveillance) {
+				store.updateSurveillance(index, iter->surveillance);
+			}
+			applied |= fields;
+		}
+		Batch *next = batch->next;
+		delete batch;
+		batch = next;
+	}
+}
+
+void
+UpdateQueue::discard()
+{
+	Batch *batch = mHead.exchange(nullptr, std::memory_order_acquire);
+	while (batch != nullptr) {
+		Batch *next = batch->next;
+		delete batch;
+		batch = next;
+	}
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef UPDATEQUEUE_H
+#define UPDATEQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "XPMPMultiplayer.h"
+#include "PlaneStore.h"
+
+/** UpdateQueue carries plane updates from the client's threads to the sim
+ * thread.
+ *
+ * Producers push copies of their updates as a single batch onto a lock-free
+ * stack, so any number of threads can push at any rate without ever waiting
+ * on each other or on the sim.  Once per frame the sim thread takes the whole
+ * stack with a single exchange and applies it newest first, so only the most
+ * recent position, surfaces and surveillance for each plane are copied into
+ * the store.
+ */
+class UpdateQueue {
+public:
+	UpdateQueue();
+	UpdateQueue(const UpdateQueue &copySrc) = delete;
+	~UpdateQueue();
+
+	UpdateQueue &operator=(const UpdateQueue &copySrc) = delete;
+
+	/** push copies inCount updates (and the structures they point to) onto the
+	 * queue.  This may be called from any thread.
+	 */
+	void push(const XPMPUpdate_t *inUpdates, size_t inUpdateSize, size_t inCount);
+
+	/** drain applies everything queued so far to store.  Sim thread only. */
+	void drain(PlaneStore &store);
+
+	/** discard throws away everything queued so far. */
+	void discard();
+
+private:
+	enum : uint8_t {
+		Has_Position = 1 << 0,
+		Has_Surfaces = 1 << 1,
+		Has_Surveillance = 1 << 2,
+	};
+
+	struct QueuedUpdate {
+		PlaneStore::Handle		handle;
+		uint8_t					fields;
+		XPMPPlanePosition_t		position;
+		XPMPPlaneSurfaces_t		surfaces;
+		XPMPPlaneSurveillance_t	surveillance;
+	};
+
+	struct Batch {
+		Batch *						next;
+		std::vector<QueuedUpdate>	updates;
+	};
+
+	std::atomic<Batch *>	mHead;
+
+	// the fields applied to each plane so far this drain.  Kept to reuse its
+	// storage between frames.
+	std::unordered_map<PlaneStore::Handle, uint8_t>	mApplied;
+};
+
+#endif //UPDATEQUEUE_H
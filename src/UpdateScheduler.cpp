@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "UpdateScheduler.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "XPMPMultiplayerVars.h"
+
+// a refresh age that's always overdue, for planes that have never been
+// refreshed.
+static const uint32_t kNeverRefreshed = 0x40000000;
+
+UpdateScheduler::UpdateScheduler() :
+	mFrame(0),
+	mCursor{},
+	mMandatory(0)
+{
+}
+
+void
+UpdateScheduler::push_back()
+{
+	mLastRefresh.push_back(mFrame - kNeverRefreshed);
+	mTier.push_back(Tier_Culled);
+	mParked.push_back(0);
+	mOutOfView.push_back(0);
+}
+
+void
+UpdateScheduler::moveLast(size_t index)
+{
+	const size_t last = mLastRefresh.size() - 1;
+	mLastRefresh[index] = mLastRefresh[last];
+	mTier[index] = mTier[last];
+	mParked[index] = mParked[last];
+	mOutOfView[index] = mOutOfView[last];
+}
+
+void
+UpdateScheduler::pop_back()
+{
+	mLastRefresh.pop_back();
+	mTier.pop_back();
+	mParked.pop_back();
+	mOutOfView.pop_back();
+}
+
+void
+UpdateScheduler::clear()
+{
+	mLastRefresh.clear();
+	mTier.clear();
+	mParked.clear();
+	mOutOfView.clear();
+	mQueue.clear();
+	mMandatory = 0;
+	mParking.clear();
+}
+
+void
+UpdateScheduler::reserve(size_t count)
+{
+	mLastRefresh.reserve(count);
+	mTier.reserve(count);
+	mParked.reserve(count);
+	mOutOfView.reserve(count);
+	mQueue.reserve(count);
+	for (auto &due: mDue) {
+		due.reserve(count);
+	}
+}
+
+void
+UpdateScheduler::plan(size_t count, const uint8_t *placed, const uint8_t *inView, const uint8_t *visible, const float *distanceSqr)
+{
+	++mFrame;
+	mQueue.clear();
+	mParking.clear();
+
+	// a distance of 0 or less turns that tier off, so a zeroed configuration
+	// refreshes every visible plane every frame.
+	const float nearDistance = gConfiguration.scheduler.nearDistance;
+	const float farDistance = gConfiguration.scheduler.farDistance;
+	const float nearSqr = (nearDistance > 0.0f) ? nearDistance * nearDistance : std::numeric_limits<float>::infinity();
+	const float farSqr = (farDistance > 0.0f) ? farDistance * farDistance : std::numeric_limits<float>::infinity();
+	const uint32_t intervals[Tier_Count] = {
+		1,
+		2,
+		4,
+		static_cast<uint32_t>(std::max(gConfiguration.scheduler.culledInterval, 1)),
+	};
+	const bool suppress = gConfiguration.offscreen.suppress;
+	const uint32_t parkAfter = static_cast<uint32_t>(std::max(gConfiguration.offscreen.parkAfterFrames, 1));
+
+	for (size_t i = 0; i < count; ++i) {
+		if (!visible[i]) {
+			mTier[i] = Tier_Culled;
+		} else if (distanceSqr[i] <= nearSqr) {
+			mTier[i] = Tier_Near;
+		} else if (distanceSqr[i] <= farSqr) {
+			mTier[i] = Tier_Mid;
+		} else {
+			mTier[i] = Tier_Far;
+		}
+		if (!placed[i]) {
+			continue;
+		}
+		bool returning = false;
+		if (suppress && !inView[i]) {
+			if (mParked[i]) {
+				continue;
+			}
+			// planes only just out of view carry on being refreshed as if
+			// suppression were off, so ones that flicker across the edge of
+			// the screen aren't parked and brought back every few frames.
+			// Once they've been out long enough they're parked, so nothing's
+			// left drawn where they used to be, and then left alone.
+			if (++mOutOfView[i] >= parkAfter) {
+				mParked[i] = 1;
+				mParking.push_back(static_cast<uint32_t>(i));
+				continue;
+			}
+		} else {
+			// anything coming back into view can't wait for its turn.
+			// Mandatory refreshes always happen, so they're marked done now to
+			// keep the tier scans below from queueing them twice.
+			returning = mOutOfView[i] != 0;
+			mOutOfView[i] = 0;
+			mParked[i] = 0;
+		}
+		if (mTier[i] == Tier_Near || returning) {
+			mQueue.push_back(static_cast<uint32_t>(i));
+			mLastRefresh[i] = mFrame;
+		}
+	}
+
+	// collect the planes that are due in the other tiers, each tier starting
+	// from where it got to.
+	for (int tier = Tier_Mid; tier < Tier_Count; ++tier) {
+		mDue[tier].clear();
+		if (mCursor[tier] >= count) {
+			mCursor[tier] = 0;
+		}
+		for (size_t n = 0, i = mCursor[tier]; n < count; ++n, i = (i + 1 < count) ? i + 1 : 0) {
+			if (placed[i] && mTier[i] == tier && !mParked[i] && (mFrame - mLastRefresh[i]) >= intervals[tier]) {
+				mDue[tier].push_back(static_cast<uint32_t>(i));
+			}
+		}
+	}
+
+	// the head of each tier is guaranteed a refresh, and the rest follow in
+	// tier order.
+	for (int tier = Tier_Mid; tier < Tier_Count; ++tier) {
+		if (!mDue[tier].empty()) {
+			mQueue.push_back(mDue[tier].front());
+		}
+	}
+	mMandatory = mQueue.size();
+	for (int tier = Tier_Mid; tier < Tier_Count; ++tier) {
+		if (mDue[tier].size() > 1) {
+			mQueue.insert(mQueue.end(), mDue[tier].begin() + 1, mDue[tier].end());
+		}
+	}
+}
+
+void
+UpdateScheduler::refreshed(size_t index)
+{
+	mLastRefresh[index] = mFrame;
+	mCursor[mTier[index]] = index + 1;
+}
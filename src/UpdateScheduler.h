@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FrameContext.h"
+
+/** UpdateScheduler decides which planes get their instances refreshed each
+ * frame.
+ *
+ * Planes are sorted into tiers by how visible they are: near visible planes
+ * are refreshed every frame, more distant ones at decreasing rates, and ones
+ * that can't be seen least often of all (see XPMPConfiguration_t).  Only the
+ * near tier is guaranteed, along with the most overdue plane in each of the
+ * other tiers; the rest share the frame's time budget in tier order.  Each
+ * tier keeps a round-robin cursor, so when the budget runs out the planes
+ * that missed out are first in line next frame, and nothing is starved even
+ * when the near tier uses the whole budget.
+ *
+ * When offscreen suppression is on, planes that stay out of view for
+ * offscreen.parkAfterFrames frames are handed back for parking, and then
+ * aren't refreshed at all.  Until then they're refreshed as if suppression
+ * were off, so their instances never stop following them, and a plane
+ * flickering across the edge of the screen isn't parked and brought back
+ * over and over.  A plane coming back into view is refreshed straight away.
+ *
+ * The view matrices are read in the flight loop, before the frame they're
+ * used for is drawn, so the frustum test is a frame behind the camera.  The
+ * guard band absorbs that for planes near the edge of the view, and the
+ * dwell before parking means a plane wrongly found out of view for a frame
+ * is still refreshed.
+ *
+ * Like the MotionEngine, its state is kept as parallel arrays indexed by the
+ * plane's dense index in the PlaneStore, which keeps them in step.
+ */
+class UpdateScheduler {
+public:
+	enum Tier : uint8_t {
+		Tier_Near = 0,
+		Tier_Mid,
+		Tier_Far,
+		Tier_Culled,
+		Tier_Count
+	};
+
+	UpdateScheduler();
+
+	void push_back();
+	/** moveLast replaces the state at index with the last plane's. */
+	void moveLast(size_t index);
+	void pop_back();
+	void clear();
+	void reserve(size_t count);
+
+	/** plan works out this frame's refresh order.
+	 *
+	 * @param count the number of planes
+	 * @param placed flags for the planes that have something to render
+	 * @param inView flags for the planes in the view frustum
+	 * @param visible flags for the planes that can be seen
+	 * @param distanceSqr the planes' squared distances from the camera
+	 */
+	void plan(size_t count, const uint8_t *placed, const uint8_t *inView, const uint8_t *visible, const float *distanceSqr);
+
+	/** parking lists the planes from plan that have now been out of view
+	 * long enough to have their instances parked.
+	 */
+	const std::vector<uint32_t> &parking() const
+	{
+		return mParking;
+	}
+
+	/** queue is the refresh order from plan: every plane that must be
+	 * refreshed this frame, followed by those that should be if there's time.
+	 */
+	const std::vector<uint32_t> &queue() const
+	{
+		return mQueue;
+	}
+
+	/** mandatory is the number of entries at the front of the queue that
+	 * must be refreshed regardless of the budget.
+	 */
+	size_t mandatory() const
+	{
+		return mMandatory;
+	}
+
+	/** refreshed records that the plane at index was refreshed this frame. */
+	void refreshed(size_t index);
+
+private:
+	std::vector<uint32_t>	mLastRefresh;	// the frame the plane was last refreshed in
+	std::vector<uint8_t>	mTier;			// the plane's tier this frame
+	std::vector<uint8_t>	mParked;		// set while the plane's out of view and parked
+	std::vector<uint32_t>	mOutOfView;		// how many frames in a row the plane's been out of view
+
+	uint32_t				mFrame;
+	size_t					mCursor[Tier_Count];
+	std::vector<uint32_t>	mDue[Tier_Count];
+	std::vector<uint32_t>	mQueue;
+	size_t					mMandatory;
+	std::vector<uint32_t>	mParking;
+};
+
+#endif //UPDATESCHEDULER_H
@@ -35,6 +35,7 @@
 
 #include <XPLMUtilities.h>
 #include <XPLMPlanes.h>
+#include <XPLMProcessing.h>
 #include <XPMPMultiplayer.h>
 #include "PlanesHandoff.h"
 
@@ -45,22 +46,35 @@
 #include "CSLLibrary.h"
 #include "XUtils.h"
 #include "Renderer.h"
+#include "UpdateQueue.h"
 #include "obj8/Obj8CSL.h"
 
 
 // This prints debug info on our process of loading Austin's planes.
 #define    DEBUG_MANUAL_LOADING    0
 
+/** XPMPPlaneIndexFromID finds the plane's current index in gPlanes.
+ *
+ * @returns PlaneStore::kNoIndex if inID is NULL or refers to a plane that's
+ *     been destroyed.
+ */
+static size_t
+XPMPPlaneIndexFromID(XPMPPlaneID inID)
+{
+    return gPlanes.indexOf(PlaneStore::handleFromID(inID));
+}
+
+/** XPMPPlaneFromID returns the plane for inID, or nullptr if it's not valid.
+ * The pointer is only good until the next plane is created or destroyed.
+ */
 static XPMPPlanePtr
-XPMPPlaneFromID(XPMPPlaneID inID, XPMPPlaneMap::iterator *outIter = nullptr)
+XPMPPlaneFromID(XPMPPlaneID inID)
 {
-    assert(inID);
-    auto planeIter = gPlanes.find(inID);
-    assert(planeIter != gPlanes.end());
-    if (outIter) {
-        *outIter = planeIter;
+    const size_t index = XPMPPlaneIndexFromID(inID);
+    if (index == PlaneStore::kNoIndex) {
+        return nullptr;
     }
-    return static_cast<XPMPPlanePtr>(inID);
+    return &gPlanes.plane(index);
 }
 
 /********************************************************************************
@@ -76,6 +90,9 @@ XPMPMultiplayerInit(XPMPConfiguration_t *inConfiguration,
         memcpy(&gConfiguration, inConfiguration, sizeof(gConfiguration));
     }
 
+    gInstanceUpdateStats.size = sizeof(gInstanceUpdateStats);
+    Obj8Attachment::initStats();
+
     // set up OBJ8 support
     Obj8CSL::Init();
 
@@ -115,6 +132,7 @@ void
 XPMPMultiplayerCleanup()
 {
     Renderer_Detach_Callbacks();
+    Obj8BoundsReader::shutdown();
 }
 
 static void MPPlanesAcquired(void *refcon)
@@ -143,6 +161,7 @@ XPMPMultiplayerDisable(void)
     XPMPMapRendering::Shutdown();
     Renderer_Detach_Callbacks();
     Planes_SafeRelease();
+    gUpdateQueue.discard();
     gPlanes.clear();
 }
 
@@ -216,15 +235,14 @@ XPMPCreatePlane(
     const char *inAirline,
     const char *inLivery)
 {
-    auto plane = std::make_unique<XPMPPlane>();
-    plane->setType(PlaneType(inICAOCode, inAirline, inLivery));
-    plane->updateCSL();
-    XPMPPlanePtr planePtr = plane.get();
-    gPlanes.emplace(planePtr, std::move(plane));
+    XPMPPlane plane;
+    plane.setType(PlaneType(inICAOCode, inAirline, inLivery));
+    plane.updateCSL();
+    const auto handle = gPlanes.add(std::move(plane));
     if (gPlanes.size() == 1) {
         Renderer_Attach_Callbacks();
     }
-    return planePtr;
+    return PlaneStore::idFromHandle(handle);
 }
 
 XPMPPlaneID
@@ -234,8 +252,8 @@ XPMPCreatePlaneWithModelName(
     const char *inAirline,
     const char *inLivery)
 {
-    auto plane = std::make_unique<XPMPPlane>();
-    plane->setType(PlaneType(inICAOCode, inAirline, inLivery));
+    XPMPPlane plane;
+    plane.setType(PlaneType(inICAOCode, inAirline, inLivery));
 
     // Find the model
     bool found = false;
@@ -247,7 +265,7 @@ XPMPCreatePlaneWithModelName(
                                                 inModelName;
                                      });
         if (cslPlane != package.planes.end()) {
-            plane->setCSL(*cslPlane);
+            plane.setCSL(*cslPlane);
             found = true;
         }
     }
@@ -257,24 +275,61 @@ XPMPCreatePlaneWithModelName(
         XPLMDebugString(inModelName);
         XPLMDebugString(" is unknown! Falling back to own model matching.");
         XPLMDebugString("\n");
-        plane->updateCSL();
+        plane.updateCSL();
     }
 
-    XPMPPlanePtr planePtr = plane.get();
-    gPlanes.emplace(planePtr, std::move(plane));
+    const auto handle = gPlanes.add(std::move(plane));
     if (gPlanes.size() == 1) {
         Renderer_Attach_Callbacks();
     }
-    return planePtr;
+    return PlaneStore::idFromHandle(handle);
 }
 
 void
-XPMPDestroyPlane(XPMPPlaneID inID)
+XPMPCreatePlanes(
+    const XPMPPlaneType_t *inTypes,
+    int inCount,
+    XPMPPlaneID *outIDs)
 {
-    XPMPPlaneMap::iterator iter;
-    XPMPPlanePtr plane = XPMPPlaneFromID(inID, &iter);
+    if (inCount <= 0) {
+        return;
+    }
+
+    // repeated types are answered by CSL_MatchPlane's cache, so each
+    // distinct type is still only matched once.
+    const bool wasEmpty = gPlanes.empty();
+    gPlanes.reserve(gPlanes.size() + inCount);
+    for (int i = 0; i < inCount; ++i) {
+        if (inTypes[i].icao == nullptr) {
+            outIDs[i] = nullptr;
+            continue;
+        }
+        PlaneType type(
+            inTypes[i].icao,
+            inTypes[i].airline ? inTypes[i].airline : "",
+            inTypes[i].livery ? inTypes[i].livery : "");
+
+        int quality = -1;
+        CSL *csl = CSL_MatchPlane(type, &quality, true);
+
+        XPMPPlane plane;
+        plane.setType(type);
+        plane.setMatchedCSL(csl, quality);
+        outIDs[i] = PlaneStore::idFromHandle(gPlanes.add(std::move(plane)));
+    }
+    if (wasEmpty && !gPlanes.empty()) {
+        Renderer_Attach_Callbacks();
+    }
+}
 
-    gPlanes.erase(iter);
+void
+XPMPDestroyPlane(XPMPPlaneID inID)
+{
+    const size_t index = XPMPPlaneIndexFromID(inID);
+    if (index == PlaneStore::kNoIndex) {
+        return;
+    }
+    gPlanes.remove(index);
     if (gPlanes.size() == 0) {
         Renderer_Detach_Callbacks();
     }
@@ -291,6 +346,9 @@ XPMPChangePlaneModel(
     PlaneType newType(inICAOCode, inAirline, inLivery);
 
     XPMPPlanePtr plane = XPMPPlaneFromID(inPlaneID);
+    if (plane == nullptr) {
+        return -1;
+    }
     if (force_change) {
         plane->setType(newType);
         plane->updateCSL();
@@ -306,7 +364,8 @@ void
 XPMPSetDefaultPlaneICAO(
     const char *inICAO)
 {
-    gDefaultPlane.mICAO = inICAO;
+    gDefaultPlane = PlaneType(inICAO);
+    CSL_FlushMatchCache();
 }
 
 long
@@ -327,6 +386,9 @@ XPMPGetPlaneModelQuality(
     XPMPPlaneID inPlane)
 {
     XPMPPlanePtr thisPlane = XPMPPlaneFromID(inPlane);
+    if (thisPlane == nullptr) {
+        return -1;
+    }
 
     return thisPlane->getMatchQuality();
 }
@@ -368,23 +430,97 @@ XPMPUpdatePlanes(
             continue;
         }
 
-        /** if the plane ID is null, skip */
-        if (thisUpdate->plane == nullptr) {
+        /** if the plane ID is null or stale, skip */
+        const size_t index = XPMPPlaneIndexFromID(thisUpdate->plane);
+        if (index == PlaneStore::kNoIndex) {
             continue;
         }
 
-        auto *plane = XPMPPlaneFromID(thisUpdate->plane);
-
         if (thisUpdate->position) {
-            plane->updatePosition(*thisUpdate->position);
+            gPlanes.updatePosition(index, *thisUpdate->position);
         }
         if (thisUpdate->surfaces) {
-            plane->updateSurfaces(*thisUpdate->surfaces);
+            gPlanes.updateSurfaces(index, *thisUpdate->surfaces);
         }
         if (thisUpdate->surveillance) {
-            plane->updateSurveillance(*thisUpdate->surveillance);
+            gPlanes.updateSurveillance(index, *thisUpdate->surveillance);
         }
 
         // guards against new struct members should begin below.
     }
 }
+
+void
+XPMPQueuePlaneUpdates(
+    const XPMPUpdate_t *inUpdates,
+    size_t inUpdateSize,
+    size_t inCount)
+{
+    gUpdateQueue.push(inUpdates, inUpdateSize, inCount);
+}
+
+void
+XPMPSetPlaneFix(
+    XPMPPlaneID inPlane,
+    const XPMPPlaneFix_t *inFix)
+{
+    const size_t index = XPMPPlaneIndexFromID(inPlane);
+    if (index == PlaneStore::kNoIndex || inFix == nullptr) {
+        return;
+    }
+
+    XPMPPlaneFix_t fix = {};
+    memcpy(&fix, inFix, std::min(inFix->size, sizeof(fix)));
+    gPlanes.setFix(index, fix, XPLMGetElapsedTime());
+}
+
+void
+XPMPGetTerrainProbeStats(
+    XPMPTerrainProbeStats_t *outStats)
+{
+    if (outStats == nullptr) {
+        return;
+    }
+    const XPMPTerrainProbeStats_t &stats = gPlanes.terrainStats();
+    const size_t size = outStats->size;
+    memcpy(outStats, &stats, std::min(size, sizeof(stats)));
+    outStats->size = size;
+}
+
+void
+XPMPGetInstanceUpdateStats(
+    XPMPInstanceUpdateStats_t *outStats)
+{
+    if (outStats == nullptr) {
+        return;
+    }
+    const size_t size = outStats->size;
+    memcpy(outStats, &gInstanceUpdateStats, std::min(size, sizeof(gInstanceUpdateStats)));
+    outStats->size = size;
+}
+
+void
+XPMPGetInstancePoolStats(
+    XPMPInstancePoolStats_t *outStats)
+{
+    if (outStats == nullptr) {
+        return;
+    }
+    const XPMPInstancePoolStats_t &stats = Obj8Attachment::poolStats();
+    const size_t size = outStats->size;
+    memcpy(outStats, &stats, std::min(size, sizeof(stats)));
+    outStats->size = size;
+}
+
+void
+XPMPGetObjectLoadStats(
+    XPMPObjectLoadStats_t *outStats)
+{
+    if (outStats == nullptr) {
+        return;
+    }
+    const XPMPObjectLoadStats_t &stats = Obj8Attachment::loadStats();
+    const size_t size = outStats->size;
+    memcpy(outStats, &stats, std::min(size, sizeof(stats)));
+    outStats->size = size;
+}
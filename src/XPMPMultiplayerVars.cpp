@@ -28,19 +28,28 @@
 
 #include "PlaneType.h"
 #include "XPMPMultiplayerVars.h"
+#include "UpdateQueue.h"
 
 XPMPConfiguration_t				gConfiguration = {
 	3.0,	// maxFullAircraftRenderingDistance
 	false,	// enableSurfaceClamping
-	{ false }	// debug options
+	{ false },	// debug options
+	0,		// loaderThreads
+	{ 1000.0f, 2000.0f, 10000.0f, 8 },	// scheduler options
+	16,		// instancePoolSize
+	4,		// maxConcurrentLoads
+	{ 8.0f, 0.1f, 45.0f },	// level of detail options
+	{ false, 50.0f, 30 },	// offscreen options
 };
 
 PlaneType						gDefaultPlane;
 
-XPMPPlaneMap					gPlanes;
+PlaneStore						gPlanes;
+UpdateQueue						gUpdateQueue;
+XPMPInstanceUpdateStats_t		gInstanceUpdateStats{};
 int								gDumpOneRenderCycle = 0;
 
 std::vector<CSLPackage_t>		gPackages;
-std::unordered_map<std::string, std::string>		gGroupings;
+std::unordered_map<Atom, Atom>		gGroupings;
 
 std::unordered_map<std::string, CSLAircraftCode_t>	gAircraftCodes;
@@ -41,6 +41,7 @@
 
 #include "CSL.h"
 #include "PlaneType.h"
+#include "StringAtoms.h"
 
 const	double	kFtToMeters = 0.3048;
 const	double	kMaxDistTCAS = 40.0 * 6080.0 * kFtToMeters;
@@ -48,8 +49,8 @@ const	double	kMaxDistTCAS = 40.0 * 6080.0 * kFtToMeters;
 /****************** MODEL MATCHING CRAP ***************/
 
 // These enums define the eight levels of matching we might possibly
-// make.  For each level of matching, we use a single string as a key.
-// (The string's contents vary with model - examples are shown.)
+// make.  For each level of matching, we use a CSLMatchKey_t as a key.
+// (The key's contents vary with model - examples are shown.)
 enum {
 	match_icao_airline_livery = 0,		//	B738 SWA SHAMU
 	match_icao_airline,					//	B738 SWA
@@ -72,6 +73,31 @@ enum {
 };
 
 
+// A matching key is the tuple of atoms for the fields used by that level of
+// matching.  Fields the level doesn't use are left as kNoAtom.
+struct CSLMatchKey_t {
+	Atom	primary;	// the ICAO code, or the group for the group levels
+	Atom	airline;
+	Atom	livery;
+
+	bool operator==(const CSLMatchKey_t &other) const
+	{
+		return primary == other.primary && airline == other.airline && livery == other.livery;
+	}
+};
+
+struct CSLMatchKeyHash {
+	size_t operator()(const CSLMatchKey_t &key) const
+	{
+		return std::hash<uint64_t>()(
+			(static_cast<uint64_t>(key.primary) << 42) ^
+			(static_cast<uint64_t>(key.airline) << 21) ^
+			static_cast<uint64_t>(key.livery));
+	}
+};
+
+typedef std::unordered_map<CSLMatchKey_t, int, CSLMatchKeyHash>	CSLMatchTable;
+
 // A CSL package - a vector of planes and six maps from the above matching 
 // keys to the internal index of the plane.
 struct	CSLPackage_t {
@@ -84,12 +110,13 @@ struct	CSLPackage_t {
 	std::string					name;
 	std::string					path;
 	std::vector<CSL *>			planes;
-	std::unordered_map<std::string, int>	matches[match_count];
+	CSLMatchTable				matches[match_count];
 };
 
 extern std::vector<CSLPackage_t>		gPackages;
 
-extern std::unordered_map<std::string, std::string>		gGroupings;
+// gGroupings maps each ICAO code to the atom for its space-joined group.
+extern std::unordered_map<Atom, Atom>		gGroupings;
 
 /**************** Model matching using ICAO doc 8643
 		(http://www.icao.int/anb/ais/TxtFiles/Doc8643.txt) ***********/
@@ -105,13 +132,18 @@ extern std::unordered_map<std::string, CSLAircraftCode_t>	gAircraftCodes;
 /**************** PLANE OBJECTS ********************/
 
 #include "XPMPPlane.h"
+#include "PlaneStore.h"
 
 typedef	XPMPPlane *								XPMPPlanePtr;
-typedef	std::unordered_map<void *, std::unique_ptr<XPMPPlane>>		XPMPPlaneMap;
+
+class PlaneStore;
+class UpdateQueue;
 
 extern XPMPConfiguration_t				gConfiguration;
 extern PlaneType						gDefaultPlane;
 
-extern XPMPPlaneMap					gPlanes;				// All planes
+extern PlaneStore						gPlanes;				// All planes
+extern UpdateQueue						gUpdateQueue;			// Updates from other threads
+extern XPMPInstanceUpdateStats_t		gInstanceUpdateStats;	// Instance update counters
 
 #endif
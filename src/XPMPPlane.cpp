@@ -47,11 +47,36 @@ XPMPPlane::XPMPPlane() :
 {
 }
 
+XPMPPlane::XPMPPlane(XPMPPlane &&moveSrc) noexcept :
+	mPlaneType(moveSrc.mPlaneType),
+	mCSL(moveSrc.mCSL),
+	mMatchQuality(moveSrc.mMatchQuality),
+	mInstanceData(moveSrc.mInstanceData)
+{
+	moveSrc.mCSL = nullptr;
+	moveSrc.mInstanceData = nullptr;
+}
+
 XPMPPlane::~XPMPPlane()
 {
 	setCSL(nullptr);
 }
 
+XPMPPlane &
+XPMPPlane::operator=(XPMPPlane &&moveSrc) noexcept
+{
+	if (this != &moveSrc) {
+		setCSL(nullptr);
+		mPlaneType = moveSrc.mPlaneType;
+		mCSL = moveSrc.mCSL;
+		mMatchQuality = moveSrc.mMatchQuality;
+		mInstanceData = moveSrc.mInstanceData;
+		moveSrc.mCSL = nullptr;
+		moveSrc.mInstanceData = nullptr;
+	}
+	return *this;
+}
+
 void
 XPMPPlane::setType(const PlaneType &type)
 {
@@ -73,100 +98,120 @@ XPMPPlane::setCSL(CSL *csl)
 	}
 }
 
-void
-XPMPPlane::updatePosition(const XPMPPlanePosition_t &newPosition)
+bool
+XPMPPlane::placeInstance(
+	const XPMPPlanePosition_t &position,
+	double &x,
+	double &y,
+	double &z,
+	TerrainCache *terrain,
+	size_t terrainIndex)
 {
-	memcpy(&mPosition, &newPosition, min(newPosition.size, sizeof(mPosition)));
+	if (mCSL == nullptr) {
+		return false;
+	}
+	return mCSL->placeInstance(x, y, z, terrain, terrainIndex, position.offsetScale, mInstanceData);
 }
 
 void
-XPMPPlane::updateSurfaces(const XPMPPlaneSurfaces_t &newSurfaces)
+XPMPPlane::updateInstanceState(
+	const FrameContext &frame,
+	double lx,
+	double ly,
+	double lz,
+	float distanceSqr,
+	const XPMPPlanePosition_t &position,
+	const XPMPPlaneSurveillance_t &surveillance)
 {
-	memcpy(&mSurface, &newSurfaces, min(newSurfaces.size, sizeof(mSurface)));
+	mCSL->updateInstanceState(frame, distanceSqr, mInstanceData);
+
+	// apply surveillance mode related masking to the TCAS inclusion record.
+	if (surveillance.mode == xpmpTransponderMode_Standby) {
+		mInstanceData->mTCAS = false;
+	}
+	// check for altitude - if difference exceeds a preconfigured limit, don't show
+	double alt_diff = position.elevation - frame.ownshipAltitude;
+	if(alt_diff < 0) alt_diff *= -1;
+	if(surveillance.mode != xpmpTransponderMode_Mode3A && alt_diff > MAX_TCAS_ALTDIFF) {
+		mInstanceData->mTCAS = false;
+	}
+	if (mInstanceData->mTCAS) {
+		// populate the global TCAS list
+		TCAS::addPlane(mInstanceData->mDistanceSqr, lx, ly, lz, surveillance.mode != xpmpTransponderMode_Mode3A);
+	}
+
+	// do labels.
+#if 0
+	if (!mInstanceData->mCulled && mInstanceData->mDistanceSqr <= (Render_LabelDistance * Render_LabelDistance)) {
+		float tx, ty;
+
+		frame.camera.ConvertTo2D(lx, ly, lz, 1.0, &tx, &ty);
+		gLabelList.emplace_back(Label{
+			tx, ty,
+			mInstanceData->mDistanceSqr,
+			string(position.label) 
+		});
+	}
+#endif
 }
 
 void
-XPMPPlane::updateSurveillance(const XPMPPlaneSurveillance_t &newSurveillance)
+XPMPPlane::refreshInstance(
+	const FrameContext &frame,
+	double lx,
+	double ly,
+	double lz,
+	const XPMPPlanePosition_t &position,
+	const XPMPPlaneSurfaces_t &surfaces)
 {
-	memcpy(&mSurveillance, &newSurveillance, min(newSurveillance.size, sizeof(mSurveillance)));
+	XPLMPlaneDrawState_t planeState = {};
+
+	planeState.structSize = sizeof(planeState);
+	planeState.gearPosition = surfaces.gearPosition;
+	planeState.flapRatio = surfaces.flapRatio;
+	planeState.spoilerRatio = surfaces.spoilerRatio;
+	planeState.speedBrakeRatio = surfaces.speedBrakeRatio;
+	planeState.slatRatio = surfaces.slatRatio;
+	planeState.wingSweep = surfaces.wingSweep;
+	planeState.thrust = surfaces.thrust;
+	planeState.yokePitch = surfaces.yokePitch;
+	planeState.yokeHeading = surfaces.yokeHeading;
+	planeState.yokeRoll = surfaces.yokeRoll;
+
+	mCSL->updateInstance(
+		frame,
+		lx,
+		ly,
+		lz,
+		position.roll,
+		position.heading,
+		position.pitch,
+		surfaces.lights,
+		mInstanceData,
+		&planeState);
 }
 
-float
-XPMPPlane::doInstanceUpdate(const CullInfo &gl_camera)
-{
-	if (mCSL) {
-		double	lx,ly,lz;
-
-		XPLMWorldToLocal(mPosition.lat, mPosition.lon, mPosition.elevation * kFtToMeters, &lx, &ly, &lz);
-		XPLMPlaneDrawState_t planeState = {};
-
-		planeState.structSize = sizeof(planeState);
-		planeState.gearPosition = mSurface.gearPosition;
-		planeState.flapRatio = mSurface.flapRatio;
-		planeState.spoilerRatio = mSurface.spoilerRatio;
-		planeState.speedBrakeRatio = mSurface.speedBrakeRatio;
-		planeState.slatRatio = mSurface.slatRatio;
-		planeState.wingSweep = mSurface.wingSweep;
-		planeState.thrust = mSurface.thrust;
-		planeState.yokePitch = mSurface.yokePitch;
-		planeState.yokeHeading = mSurface.yokeHeading;
-		planeState.yokeRoll = mSurface.yokeRoll;
-
-        mCSL->updateInstance(
-            gl_camera,
-            lx,
-            ly,
-            lz,
-            mPosition.roll,
-            mPosition.heading,
-            mPosition.pitch,
-            mPosition.clampToGround,
-            mPosition.offsetScale,
-            mSurface.lights,
-            mInstanceData,
-            &planeState);
-
-		if (mInstanceData == nullptr) {
-			return 0.0;
-		}
-		// apply surveillance mode related masking to the TCAS inclusion record.
-		if (mSurveillance.mode == xpmpTransponderMode_Standby) {
-			mInstanceData->mTCAS = false;
-		}
-		// check for altitude - if difference exceeds a preconfigured limit, don't show
-		double acft_alt = XPLMGetDatad(TCAS::gAltitudeRef) / kFtToMeters;
-		double alt_diff = mPosition.elevation - acft_alt;
-		if(alt_diff < 0) alt_diff *= -1;
-		if(mSurveillance.mode != xpmpTransponderMode_Mode3A && alt_diff > MAX_TCAS_ALTDIFF) {
-			mInstanceData->mTCAS = false;
-		}
-		if (mInstanceData->mTCAS) {
-			// populate the global TCAS list
-			TCAS::addPlane(mInstanceData->mDistanceSqr, lx, ly, lz, mSurveillance.mode != xpmpTransponderMode_Mode3A);
-		}
-
-		// do labels.
-#if 0
-		if (!mInstanceData->mCulled && mInstanceData->mDistanceSqr <= (Render_LabelDistance * Render_LabelDistance)) {
-			float tx, ty;
-
-			gl_camera.ConvertTo2D(lx, ly, lz, 1.0, &tx, &ty);
-			gLabelList.emplace_back(Label{
-				tx, ty,
-				mInstanceData->mDistanceSqr,
-				string(mPosition.label) 
-			});
-		}
-#endif
-		return mInstanceData->mDistanceSqr;
+void
+XPMPPlane::parkInstance()
+{
+	if (mCSL != nullptr && mInstanceData != nullptr) {
+		mCSL->parkInstance(mInstanceData);
 	}
-	return 0.0;
 }
 
 void
 XPMPPlane::setCSL(const PlaneType &type)
 {
-	setCSL(CSL_MatchPlane(type, &mMatchQuality, true));
+	int matchQuality;
+	CSL *csl = CSL_MatchPlane(type, &matchQuality, true);
+	setMatchedCSL(csl, matchQuality);
+}
+
+void
+XPMPPlane::setMatchedCSL(CSL *csl, int matchQuality)
+{
+	setCSL(csl);
+	mMatchQuality = matchQuality;
 }
 
 void
@@ -193,3 +238,12 @@ XPMPPlane::getMatchQuality()
 {
 	return mMatchQuality;
 }
+
+float
+XPMPPlane::getBoundingRadius() const
+{
+	if (mCSL == nullptr) {
+		return CSL::kDefaultBoundingRadius;
+	}
+	return mCSL->getBoundingRadius();
+}
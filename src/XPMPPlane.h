@@ -25,32 +25,38 @@
 
 #include "XPMPMultiplayerVars.h"
 #include "PlaneType.h"
-#include "CullInfo.h"
-
-class XPMPMapRendering;
+#include "FrameContext.h"
+#include "TerrainCache.h"
 
+/** XPMPPlane holds the model matching and rendering state for a single plane.
+ *
+ * The state the client updates every frame (position, surfaces and
+ * surveillance) is kept by the PlaneStore in dense arrays alongside it.
+ */
 class XPMPPlane {
 private:
-	// world state
 	PlaneType			mPlaneType;
 
-	XPMPPlanePosition_t	mPosition;
-	XPMPPlaneSurfaces_t	mSurface;
-	XPMPPlaneSurveillance_t	mSurveillance;
-
 	// rendering data
 	CSL *				mCSL;
 	int					mMatchQuality;
 
-	friend void Render_PrepLists();
-	friend class XPMPMapRendering;
 public:
 	XPMPPlane();
+	XPMPPlane(XPMPPlane &&moveSrc) noexcept;
+	XPMPPlane(const XPMPPlane &copySrc) = delete;
 	virtual ~XPMPPlane();
 
+	XPMPPlane &operator=(XPMPPlane &&moveSrc) noexcept;
+	XPMPPlane &operator=(const XPMPPlane &copySrc) = delete;
+
 	void setType(const PlaneType &type);
 	void setCSL(CSL *csl);
 	void setCSL(const PlaneType &type);
+	/** setMatchedCSL sets the CSL and match quality from a match that's
+	 * already been made for this plane's type.
+	 */
+	void setMatchedCSL(CSL *csl, int matchQuality);
 	void updateCSL();
 	/** upgradeCSL works mostly like setCSL, only it only takes hold if the new
 	 * CSL is a higher quality match than the old one.
@@ -61,17 +67,75 @@ public:
 	bool upgradeCSL(const PlaneType &type);
 	int  getMatchQuality();
 
-	void updatePosition(const XPMPPlanePosition_t &newPosition);
-	void updateSurfaces(const XPMPPlaneSurfaces_t &newSurfaces);
-	void updateSurveillance(const XPMPPlaneSurveillance_t &newSurveillance);
+	/** getBoundingRadius returns the bounding radius (in metres) of the
+	 * plane's model, for culling.
+	 */
+	float getBoundingRadius() const;
 
-	/** Updates the specific plane's instance data and prepares it's tcas
-	 * (and culling flags for selfrendered models)
+	/** placeInstance works out where the plane's instance goes this frame,
+	 * creating the instance data if needed.
 	 *
-	 * @param gl_camera the CullInfo from the rendering loop
-	 * @returns the square of the distance from the camera
+	 * @param position the plane's current position
+	 * @param x
+	 * @param y
+	 * @param z the plane's position in local coordinates, adjusted in place
+	 * @param terrain the TerrainCache to clamp with, or nullptr if the plane
+	 *     shouldn't be clamped to the surface
+	 * @param terrainIndex the plane's entry in the terrain cache
+	 * @returns false if the plane has nothing to render
+	 */
+	bool placeInstance(
+		const XPMPPlanePosition_t &position,
+		double &x,
+		double &y,
+		double &z,
+		TerrainCache *terrain,
+		size_t terrainIndex);
+
+	/** Updates the specific plane's distance, cull and TCAS state, and adds
+	 * it to the TCAS list if it qualifies.  This must be done every frame
+	 * for every plane placed by placeInstance.
+	 *
+	 * @param frame the FrameContext from the rendering loop
+	 * @param x
+	 * @param y
+	 * @param z the plane's position from placeInstance
+	 * @param distanceSqr the square of the distance from the camera
+	 * @param position the plane's current position
+	 * @param surveillance the plane's current transponder state
+	 */
+	void updateInstanceState(
+		const FrameContext &frame,
+		double x,
+		double y,
+		double z,
+		float distanceSqr,
+		const XPMPPlanePosition_t &position,
+		const XPMPPlaneSurveillance_t &surveillance);
+
+	/** Pushes the plane's position, control surfaces and lights to its
+	 * instances.  The plane must have been placed by placeInstance this
+	 * frame.
+	 *
+	 * @param frame the FrameContext from the rendering loop
+	 * @param x
+	 * @param y
+	 * @param z the plane's position from placeInstance
+	 * @param position the plane's current position
+	 * @param surfaces the plane's current control surfaces and lights
+	 */
+	void refreshInstance(
+		const FrameContext &frame,
+		double x,
+		double y,
+		double z,
+		const XPMPPlanePosition_t &position,
+		const XPMPPlaneSurfaces_t &surfaces);
+
+	/** Parks the plane's instances while it's out of view.  The next
+	 * refreshInstance brings them back.
 	 */
-	float doInstanceUpdate(const CullInfo &gl_camera);
+	void parkInstance();
 
 	// instanceData is public for the convenience of the main render loop only.
 	CSLInstanceData *	mInstanceData;
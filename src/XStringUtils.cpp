@@ -65,6 +65,37 @@ namespace xpmp {
 		}
 	}
 
+	void
+	tokenize(string_view str, string_view delim, vector<string_view> &outTokens, int n)
+	{
+		outTokens.clear();
+		if (delim.empty() || n == 1)
+		{
+			outTokens.emplace_back(str);
+			return;
+		}
+
+		while (!str.empty())
+		{
+			auto 		position = str.find_first_of(delim);
+			string_view	token = str.substr(0, position);
+
+			if (!token.empty())
+			{
+				outTokens.emplace_back(token);
+			}
+
+			// Nothing remaining
+			if (position == string_view::npos) return;
+
+			str.remove_prefix(position + 1);
+			if (n > 0 && outTokens.size() >= static_cast<size_t>(n-1)) {
+				outTokens.emplace_back(str);
+				return;
+			}
+		}
+	}
+
 	// trim from start (in place)
 	void
 		ltrim(std::string &s)
@@ -87,6 +118,18 @@ namespace xpmp {
 		rtrim(s);
 	}
 
+	// trim a view from both ends (in place)
+	void
+		trim(std::string_view &s)
+	{
+		while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
+			s.remove_prefix(1);
+		}
+		while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
+			s.remove_suffix(1);
+		}
+	}
+
 	//FIXME: this whole function needs to be reconsidered - stringformat variants are far fewer these days.
 	// This routine gets one line, but handles any platforms crlf setup.
 	char *
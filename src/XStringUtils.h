@@ -25,6 +25,7 @@
 #define STRING_UTILS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace xpmp {
@@ -39,6 +40,23 @@ namespace xpmp {
     std::vector<std::string>
     tokenize(const std::string &str, const std::string &delim, int n = 0);
 
+	/** tokenize splits the string into no more than n tokens without copying it.
+	 *
+	 * This behaves exactly like the std::string variant above, only the tokens
+	 * are views into str, so the caller must keep the underlying buffer alive
+	 * (and unmodified) for as long as it uses the tokens.
+	 *
+	 * @param str the string to split
+	 * @param delim a string containing the delimiting characters.
+	 * @param outTokens vector to receive the tokens.  It is cleared first, so
+	 *     callers can reuse it between lines to avoid reallocating.
+	 * @param n the maximum number of tokens to produce.  If 0, then there's no limit.
+	 */
+	void
+	tokenize(std::string_view str, std::string_view delim, std::vector<std::string_view> &outTokens, int n = 0);
+
+	void	trim(std::string_view &s);
+
 	void	ltrim(std::string &s);
 	void	rtrim(std::string &s);
 	void	trim(std::string &s);
@@ -52,3 +52,26 @@ bool DoesFileExist(const std::string &filePath)
 	std::ifstream infile(filePath);
 	return infile.good();
 }
+
+thread_local XPLMDumpCapture *XPLMDumpCapture::sActive = nullptr;
+
+XPLMDumpCapture::XPLMDumpCapture() :
+	mPrevious(sActive)
+{
+	sActive = this;
+}
+
+XPLMDumpCapture::~XPLMDumpCapture()
+{
+	sActive = mPrevious;
+}
+
+void
+XPLMDump::write(const char *text)
+{
+	if (XPLMDumpCapture::sActive) {
+		XPLMDumpCapture::sActive->text += text;
+	} else {
+		XPLMDebugString(text);
+	}
+}
@@ -24,6 +24,7 @@
 #define XUTILS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <XPLMUtilities.h>
@@ -40,49 +41,80 @@ struct XPLMDump {
 	XPLMDump() { }
 
 	XPLMDump(const std::string& inFileName, int lineNum, const char * line) {
-		XPLMDebugString(XPMP_CLIENT_NAME " WARNING: Parse Error in file ");
-		XPLMDebugString(inFileName.c_str());
-		XPLMDebugString(" line ");
+		write(XPMP_CLIENT_NAME " WARNING: Parse Error in file ");
+		write(inFileName.c_str());
+		write(" line ");
 		char buf[32];
 		sprintf(buf,"%d", lineNum);
-		XPLMDebugString(buf);
-		XPLMDebugString(".\n              ");
-		XPLMDebugString(line);
-		XPLMDebugString(".\n");
+		write(buf);
+		write(".\n              ");
+		write(line);
+		write(".\n");
 	}
 
-	XPLMDump(const std::string& inFileName, int lineNum, const std::string& line) {
-		XPLMDebugString(XPMP_CLIENT_NAME " WARNING: Parse Error in file ");
-		XPLMDebugString(inFileName.c_str());
-		XPLMDebugString(" line ");
-		char buf[32];
-		sprintf(buf,"%d", lineNum);
-		XPLMDebugString(buf);
-		XPLMDebugString(".\n              ");
-		XPLMDebugString(line.c_str());
-		XPLMDebugString(".\n");
+	XPLMDump(const std::string& inFileName, int lineNum, const std::string& line) :
+		XPLMDump(inFileName, lineNum, line.c_str())
+	{
+	}
+
+	XPLMDump(const std::string& inFileName, int lineNum, std::string_view line) :
+		XPLMDump(inFileName, lineNum, std::string(line))
+	{
 	}
 
 	XPLMDump& operator<<(const char * rhs) {
-		XPLMDebugString(rhs);
+		write(rhs);
 		return *this;
 	}
 	XPLMDump& operator<<(const std::string& rhs) {
-		XPLMDebugString(rhs.c_str());
+		write(rhs.c_str());
+		return *this;
+	}
+	XPLMDump& operator<<(std::string_view rhs) {
+		write(std::string(rhs).c_str());
 		return *this;
 	}
 	XPLMDump& operator<<(int n) {
 		char buf[255];
 		sprintf(buf, "%d", n);
-		XPLMDebugString(buf);
+		write(buf);
 		return *this;
 	}
 	XPLMDump& operator<<(size_t n) {
 		char buf[255];
 		sprintf(buf, "%u", static_cast<unsigned>(n));
-		XPLMDebugString(buf);
+		write(buf);
 		return *this;
 	}
+
+	/** write sends the text to the X-Plane log, unless an XPLMDumpCapture is
+	 * active on the calling thread, in which case it's buffered there instead.
+	 */
+	static void write(const char *text);
+};
+
+/** XPLMDumpCapture redirects all XPLMDump output on the current thread into a
+ * buffer for as long as it's in scope.
+ *
+ * The SDK must only be called from the sim thread, so worker threads use this
+ * to hold onto their diagnostics until the sim thread can log them.
+ */
+class XPLMDumpCapture {
+public:
+	XPLMDumpCapture();
+	~XPLMDumpCapture();
+
+	XPLMDumpCapture(const XPLMDumpCapture &copySrc) = delete;
+	XPLMDumpCapture &operator=(const XPLMDumpCapture &copySrc) = delete;
+
+	/** the output captured so far */
+	std::string		text;
+
+private:
+	friend struct XPLMDump;
+
+	XPLMDumpCapture *	mPrevious;
+	static thread_local XPLMDumpCapture *	sActive;
 };
 
 #endif
@@ -24,39 +24,88 @@
 
 #include "Obj8Attachment.h"
 
+#include <algorithm>
 #include <queue>
 #include <XPLMScenery.h>
+#include <XPLMUtilities.h>
 #include <XUtils.h>
+#include <XPMPMultiplayerVars.h>
 
-std::queue<Obj8Attachment *>	Obj8Attachment::loadQueue;
+std::queue<std::unique_ptr<Obj8Attachment::LoadRequest>>	Obj8Attachment::loadQueue;
 std::unordered_map<std::string,std::weak_ptr<Obj8Attachment>> Obj8Attachment::sAttachmentCache;
+XPMPInstancePoolStats_t	Obj8Attachment::sPoolStats{};
+XPMPObjectLoadStats_t	Obj8Attachment::sLoadStats{};
+
+static double	gTotalLoadLatency = 0.0;
+static double	gTotalLoadTime = 0.0;
+
+void
+Obj8Attachment::initStats()
+{
+    sPoolStats.size = sizeof(sPoolStats);
+    sLoadStats.size = sizeof(sLoadStats);
+}
 
 void
 Obj8Attachment::loadCallback(XPLMObjectRef inObject, void *inRefcon)
 {
-    auto *sThis = reinterpret_cast<Obj8Attachment *>(inRefcon);
+    std::unique_ptr<LoadRequest> request(reinterpret_cast<LoadRequest *>(inRefcon));
 
-    sThis->mHandle = inObject;
+    // account for the load before anything else, so the slot is freed even
+    // if the attachment's gone.
+    const auto now = std::chrono::steady_clock::now();
+    sLoadStats.inFlight--;
+    sLoadStats.completed++;
     if (nullptr == inObject) {
-        sThis->mLoadState = Obj8LoadState::Failed;
-        XPLMDump() << XPMP_CLIENT_NAME << " failed to load obj8: " << sThis->mFile << "\n";
+        sLoadStats.failed++;
+    }
+    gTotalLoadLatency += std::chrono::duration<double>(now - request->queuedAt).count();
+    gTotalLoadTime += std::chrono::duration<double>(now - request->startedAt).count();
+    sLoadStats.averageLatency = static_cast<float>(gTotalLoadLatency / sLoadStats.completed);
+    sLoadStats.averageLoadTime = static_cast<float>(gTotalLoadTime / sLoadStats.completed);
+
+    auto sThis = request->attachment.lock();
+    if (!sThis) {
+        // nothing wants it any more.
+        if (nullptr != inObject) {
+            XPLMUnloadObject(inObject);
+        }
     } else {
-        XPLMDump() << XPMP_CLIENT_NAME << " did load obj8: " << sThis->mFile << "\n";
-        sThis->mLoadState = Obj8LoadState::Loaded;
+        sThis->mHandle = inObject;
+        if (nullptr == inObject) {
+            sThis->mLoadState = Obj8LoadState::Failed;
+            XPLMDump() << XPMP_CLIENT_NAME << " failed to load obj8: " << sThis->mFile << "\n";
+        } else {
+            XPLMDump() << XPMP_CLIENT_NAME << " did load obj8: " << sThis->mFile << "\n";
+            sThis->mLoadState = Obj8LoadState::Loaded;
+        }
     }
 
-    if (!loadQueue.empty()) {
-        Obj8Attachment *nextAtt = nullptr;
-        nextAtt = loadQueue.front();
+    startLoads();
+}
+
+void
+Obj8Attachment::startLoads()
+{
+    const long maxLoads = std::max(gConfiguration.maxConcurrentLoads, 1);
+    while (sLoadStats.inFlight < maxLoads && !loadQueue.empty()) {
+        std::unique_ptr<LoadRequest> request = std::move(loadQueue.front());
         loadQueue.pop();
-        if (nextAtt) {
-            XPLMLoadObjectAsync(nextAtt->mFile.c_str(), &Obj8Attachment::loadCallback, reinterpret_cast<void *>(nextAtt));
+        sLoadStats.queued--;
+        if (request->attachment.expired()) {
+            continue;
         }
+        request->startedAt = std::chrono::steady_clock::now();
+        sLoadStats.inFlight++;
+        // the sim owns the request until it calls back.
+        const std::string &file = request->file;
+        LoadRequest *refcon = request.release();
+        XPLMLoadObjectAsync(file.c_str(), &Obj8Attachment::loadCallback, reinterpret_cast<void *>(refcon));
     }
 }
 
 std::shared_ptr<Obj8Attachment>
-Obj8Attachment::getAttachmentForFile(const std::string &filename)
+Obj8Attachment::getAttachmentForFile(const std::string &filename, const std::string &fullPath)
 {
     auto wpIter = sAttachmentCache.find(filename);
     if (wpIter != sAttachmentCache.end()) {
@@ -65,7 +114,7 @@ Obj8Attachment::getAttachmentForFile(const std::string &filename)
             return std::move(sp);
         }
     }
-    auto sp = std::shared_ptr<Obj8Attachment>(new Obj8Attachment(filename));
+    auto sp = std::shared_ptr<Obj8Attachment>(new Obj8Attachment(filename, fullPath));
     sAttachmentCache[filename] = sp;
     return std::move(sp);
 }
@@ -79,16 +128,85 @@ Obj8Attachment::enqueueLoad() {
         return;
     }
     mLoadState = Obj8LoadState::Loading;
-    if (loadQueue.empty()) {
-        XPLMLoadObjectAsync(mFile.c_str(), &Obj8Attachment::loadCallback, reinterpret_cast<void *>(this));
-    } else {
-        loadQueue.push(this);
-    }
+
+    std::unique_ptr<LoadRequest> request(new LoadRequest());
+    request->attachment = weak_from_this();
+    request->file = mFile;
+    request->queuedAt = std::chrono::steady_clock::now();
+    loadQueue.push(std::move(request));
+    sLoadStats.queued++;
+    startLoads();
 };
 
 
+XPLMInstanceRef
+Obj8Attachment::acquireInstance(const char **datarefs)
+{
+    if (!mFreeInstances.empty()) {
+        XPLMInstanceRef instance = mFreeInstances.back();
+        mFreeInstances.pop_back();
+        sPoolStats.pooled--;
+        sPoolStats.reused++;
+        return instance;
+    }
+    XPLMObjectRef handle = getObjectHandle();
+    if (nullptr == handle) {
+        return nullptr;
+    }
+    sPoolStats.created++;
+    return XPLMCreateInstance(handle, datarefs);
+}
+
+void
+Obj8Attachment::releaseInstance(XPLMInstanceRef instance, const float *datarefValues)
+{
+    if (nullptr == instance) {
+        return;
+    }
+    if (mFreeInstances.size() < static_cast<size_t>(std::max(gConfiguration.instancePoolSize, 0))) {
+        XPLMDrawInfo_t parked = {};
+        parked.structSize = sizeof(parked);
+        parked.y = kParkedElevation;
+        XPLMInstanceSetPosition(instance, &parked, datarefValues);
+        mFreeInstances.push_back(instance);
+        sPoolStats.pooled++;
+        return;
+    }
+    XPLMDestroyInstance(instance);
+    sPoolStats.destroyed++;
+}
+
+Obj8BoundsState
+Obj8Attachment::getBounds(Obj8Bounds &bounds)
+{
+    if (!mBoundsRequest) {
+        if (mFullPath.empty()) {
+            return Obj8BoundsState::Failed;
+        }
+        mBoundsRequest = Obj8BoundsReader::request(mFullPath);
+    }
+    const Obj8BoundsState state = mBoundsRequest->state.load(std::memory_order_acquire);
+    if (state == Obj8BoundsState::Ready) {
+        bounds = mBoundsRequest->bounds;
+    } else if (state == Obj8BoundsState::Failed && !mBoundsFailureLogged) {
+        mBoundsFailureLogged = true;
+        if (gConfiguration.debug.modelMatching) {
+            XPLMDump() << XPMP_CLIENT_NAME << " couldn't read the bounds of obj8: " << mFullPath << "\n";
+        }
+    }
+    return state;
+}
+
 Obj8Attachment::~Obj8Attachment()
 {
+    // the pooled instances have to go before their object does.
+    for (auto &instance: mFreeInstances) {
+        XPLMDestroyInstance(instance);
+    }
+    sPoolStats.pooled -= static_cast<long>(mFreeInstances.size());
+    sPoolStats.destroyed += static_cast<long>(mFreeInstances.size());
+    mFreeInstances.clear();
+
     if (mHandle != nullptr) {
         XPLMUnloadObject(mHandle);
         mLoadState = Obj8LoadState::None;
@@ -25,32 +25,40 @@
 #ifndef OBJ8ATTACHMENT_H
 #define OBJ8ATTACHMENT_H
 
+#include <chrono>
 #include <string>
 #include <utility>
 #include <queue>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <XPLMScenery.h>
+#include <XPLMInstance.h>
+#include <XPMPMultiplayer.h>
 
 #include "Obj8Common.h"
+#include "Obj8Bounds.h"
 
 /** Obj8Attachment is a single obj8 component loaded and ready for rendering.
  */
-class Obj8Attachment {
+class Obj8Attachment : public std::enable_shared_from_this<Obj8Attachment> {
 public:
     /** use this to construct Obj8Attachments - it'll handle deduplication if
      * necessary.
      *
      * @param filename POSIX path to the obj8 to load
+     * @param fullPath native absolute path to the same obj8, for reading it
+     *     directly
      * @return a std::shared_ptr for the requested obj8 attachment
      */
-    static std::shared_ptr<Obj8Attachment> getAttachmentForFile(const std::string &filename);
+    static std::shared_ptr<Obj8Attachment> getAttachmentForFile(const std::string &filename, const std::string &fullPath);
 
 	Obj8Attachment(const Obj8Attachment &copySrc) = delete;
 
 	Obj8Attachment(Obj8Attachment &&moveSrc) noexcept:
             mFile(std::move(moveSrc.mFile)),
+            mFullPath(std::move(moveSrc.mFullPath)),
             mHandle(nullptr),
             mLoadState(Obj8LoadState::None)
     {
@@ -59,6 +67,12 @@ public:
 
         mLoadState = moveSrc.mLoadState;
         moveSrc.mLoadState = Obj8LoadState::None;
+
+        mFreeInstances = std::move(moveSrc.mFreeInstances);
+        moveSrc.mFreeInstances.clear();
+
+        mBoundsRequest = std::move(moveSrc.mBoundsRequest);
+        mBoundsFailureLogged = moveSrc.mBoundsFailureLogged;
     }
 
 	virtual ~Obj8Attachment();
@@ -84,13 +98,63 @@ public:
 	    return mLoadState;
 	}
 
+	/** acquireInstance gets an instance of this attachment, re-using a pooled
+	 * one if there is one.  The object is queued for loading if needed.
+	 *
+	 * @param datarefs the dataref names for a new instance, which must be the
+	 *     same for every instance of the attachment.
+	 * @returns the instance, or nullptr if the object isn't loaded yet.
+	 */
+	XPLMInstanceRef	acquireInstance(const char **datarefs);
+
+	/** kParkedElevation is where instances that shouldn't be seen are moved
+	 * to, as X-Plane draws every instance that exists. */
+	static constexpr float kParkedElevation = -1.0e6f;
+
+	/** releaseInstance returns an instance from acquireInstance to the pool,
+	 * or destroys it if the pool is full.  Pooled instances are still drawn,
+	 * so they're parked at kParkedElevation.
+	 *
+	 * @param instance the instance to release
+	 * @param datarefValues values for the instance's datarefs to park it with
+	 */
+	void			releaseInstance(XPLMInstanceRef instance, const float *datarefValues);
+
+	/** getBounds gets the extent of the attachment's object, which is read
+	 * in the background.  The first call queues the read.
+	 *
+	 * @param bounds receives the bounds once they're ready.
+	 * @returns the state of the read.  bounds is only set if it's Ready.
+	 */
+	Obj8BoundsState	getBounds(Obj8Bounds &bounds);
+
+	/** initStats sets the size of the counters' structs.  It's called from
+	 * XPMPMultiplayerInit.
+	 */
+	static void initStats();
+
+	/** poolStats reports the instance pool counters for every attachment. */
+	static const XPMPInstancePoolStats_t &poolStats() {
+	    return sPoolStats;
+	}
+
+	/** loadStats reports the object load queue counters. */
+	static const XPMPObjectLoadStats_t &loadStats() {
+	    return sLoadStats;
+	}
+
 protected:
 	std::string			mFile;
+	std::string			mFullPath;
 	XPLMObjectRef		mHandle;
 	Obj8LoadState		mLoadState;
+	std::vector<XPLMInstanceRef>	mFreeInstances;
+	std::shared_ptr<Obj8BoundsRequest>	mBoundsRequest;
+	bool				mBoundsFailureLogged = false;
 
-    explicit Obj8Attachment(std::string fileName):
+    Obj8Attachment(std::string fileName, std::string fullPath):
         mFile(std::move(fileName)),
+        mFullPath(std::move(fullPath)),
         mHandle(nullptr),
         mLoadState(Obj8LoadState::None)
     {
@@ -98,9 +162,24 @@ protected:
 
 
 private:
+    /** LoadRequest tracks a load from being queued until the sim calls back.
+     * It only holds a weak reference, so the attachment can go away while
+     * it's loading. */
+    struct LoadRequest {
+        std::weak_ptr<Obj8Attachment>	attachment;
+        std::string						file;
+        std::chrono::steady_clock::time_point	queuedAt;
+        std::chrono::steady_clock::time_point	startedAt;
+    };
+
     static std::unordered_map<std::string,std::weak_ptr<Obj8Attachment>> sAttachmentCache;
     static void	loadCallback(XPLMObjectRef inObject, void *inRefcon);
-    static std::queue<Obj8Attachment *>	loadQueue;
+    /** startLoads hands queued loads to the sim until maxConcurrentLoads
+     * are in flight. */
+    static void	startLoads();
+    static std::queue<std::unique_ptr<LoadRequest>>	loadQueue;
+    static XPMPInstancePoolStats_t	sPoolStats;
+    static XPMPObjectLoadStats_t	sLoadStats;
     void enqueueLoad();
 };
 
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "Obj8Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "XStringUtils.h"
+
+// The worker's state is never freed, so a worker that's been let go at exit
+// can't be left waiting on anything that's been destroyed under it.
+struct BoundsWorkerState {
+	std::mutex										mutex;
+	std::condition_variable							wake;
+	std::deque<std::shared_ptr<Obj8BoundsRequest>>	queue;
+	std::thread										thread;
+	bool											stopping = false;
+};
+static BoundsWorkerState &gBounds = *new BoundsWorkerState;
+
+// XPMPMultiplayerCleanup is what stops the thread.  If the host never called
+// it, the thread is told to stop and let go rather than joined, as joining
+// one while the module unloads can deadlock on Windows' loader lock.
+static struct BoundsThreadGuard {
+	~BoundsThreadGuard()
+	{
+		std::lock_guard<std::mutex> lock(gBounds.mutex);
+		if (gBounds.thread.joinable()) {
+			gBounds.stopping = true;
+			gBounds.wake.notify_one();
+			gBounds.thread.detach();
+		}
+	}
+} gBoundsThreadGuard;
+
+static void
+BoundsWorker()
+{
+	std::unique_lock<std::mutex> lock(gBounds.mutex);
+	for (;;) {
+		gBounds.wake.wait(lock, [] { return gBounds.stopping || !gBounds.queue.empty(); });
+		if (gBounds.stopping) {
+			return;
+		}
+		std::shared_ptr<Obj8BoundsRequest> request = std::move(gBounds.queue.front());
+		gBounds.queue.pop_front();
+
+		lock.unlock();
+		const bool ok = Obj8BoundsReader::readBounds(request->path, request->bounds);
+		request->state.store(ok ? Obj8BoundsState::Ready : Obj8BoundsState::Failed, std::memory_order_release);
+		lock.lock();
+	}
+}
+
+std::shared_ptr<Obj8BoundsRequest>
+Obj8BoundsReader::request(const std::string &path)
+{
+	auto request = std::make_shared<Obj8BoundsRequest>(path);
+	std::lock_guard<std::mutex> lock(gBounds.mutex);
+	if (!gBounds.thread.joinable()) {
+		gBounds.stopping = false;
+		gBounds.thread = std::thread(BoundsWorker);
+	}
+	gBounds.queue.push_back(request);
+	gBounds.wake.notify_one();
+	return request;
+}
+
+void
+Obj8BoundsReader::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(gBounds.mutex);
+		gBounds.stopping = true;
+		gBounds.wake.notify_one();
+	}
+	if (gBounds.thread.joinable()) {
+		gBounds.thread.join();
+	}
+	std::lock_guard<std::mutex> lock(gBounds.mutex);
+	for (auto &request: gBounds.queue) {
+		request->state.store(Obj8BoundsState::Failed, std::memory_order_release);
+	}
+	gBounds.queue.clear();
+}
+
+bool
+Obj8BoundsReader::readBounds(const std::string &path, Obj8Bounds &bounds)
+{
+	std::ifstream in(path);
+	if (!in) {
+		return false;
+	}
+
+	float minimum[3] = {0.0f, 0.0f, 0.0f};
+	float maximum[3] = {0.0f, 0.0f, 0.0f};
+	float radiusSqr = 0.0f;
+	bool found = false;
+	auto addPoint = [&](const std::string_view *coords) {
+		float p[3];
+		for (int axis = 0; axis < 3; axis++) {
+			// the tokens are views into a std::string, so they're followed by
+			// a delimiter or the terminator.
+			p[axis] = std::strtof(coords[axis].data(), nullptr);
+			minimum[axis] = found ? std::min(minimum[axis], p[axis]) : p[axis];
+			maximum[axis] = found ? std::max(maximum[axis], p[axis]) : p[axis];
+		}
+		radiusSqr = std::max(radiusSqr, p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+		found = true;
+	};
+
+	// everything that draws is either a vertex or a light, so only those
+	// records are parsed; the rest of the file is skipped over.
+	//
+	// POINT_COUNTS would let us stop after the vertex tables, but the
+	// LIGHT_NAMED, LIGHT_PARAM and LIGHT_CUSTOM lights are commands, and the
+	// command section is the end of the file, after the indices.  Lights sit
+	// out on the wingtips and tail, so leaving them out would shrink the
+	// bounds, and we have to read to the end.  The indices, which are most of
+	// what's skipped, are rejected on their first character without being
+	// tokenized.
+	std::string line;
+	std::vector<std::string_view> tokens;
+	while (std::getline(in, line)) {
+		const size_t start = line.find_first_not_of(" \t");
+		if (start == std::string::npos || (line[start] != 'V' && line[start] != 'L')) {
+			continue;
+		}
+		xpmp::tokenize(line, " \t\r", tokens);
+		if (tokens.empty()) {
+			continue;
+		}
+		const std::string_view &cmd = tokens[0];
+		if ((cmd == "VT" || cmd == "VLINE" || cmd == "VLIGHT" ||
+			cmd == "LIGHT_CUSTOM" || cmd == "LIGHT_SPILL_CUSTOM") && tokens.size() >= 4) {
+			addPoint(&tokens[1]);
+		} else if ((cmd == "LIGHT_NAMED" || cmd == "LIGHT_PARAM") && tokens.size() >= 5) {
+			addPoint(&tokens[2]);
+		}
+	}
+	if (!found) {
+		return false;
+	}
+
+	std::copy(minimum, minimum + 3, bounds.min);
+	std::copy(maximum, maximum + 3, bounds.max);
+	bounds.radius = std::sqrt(radiusSqr);
+	return true;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018, 2020, Chris Collins.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef OBJ8BOUNDS_H
+#define OBJ8BOUNDS_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+/** Obj8Bounds is the extent of an OBJ8 object's geometry and lights, in the
+ * object's own coordinates (metres).
+ */
+struct Obj8Bounds {
+	float	min[3];		// the corners of the bounding box
+	float	max[3];
+	float	radius;		// the radius of the bounding sphere about the origin
+};
+
+enum class Obj8BoundsState {
+	Pending = 0,	// still waiting to be read
+	Ready,			// bounds is valid
+	Failed			// the file couldn't be read, or had nothing in it
+};
+
+/** Obj8BoundsRequest is a request to the Obj8BoundsReader for one file.
+ *
+ * bounds may only be read once state is Ready.
+ */
+struct Obj8BoundsRequest {
+	explicit Obj8BoundsRequest(std::string filePath) :
+		path(std::move(filePath)),
+		state(Obj8BoundsState::Pending),
+		bounds{}
+	{
+	}
+
+	const std::string				path;
+	std::atomic<Obj8BoundsState>	state;
+	Obj8Bounds						bounds;
+};
+
+/** Obj8BoundsReader works out Obj8Bounds for OBJ8 files on a background
+ * thread, so the sim never waits on the file reads.
+ */
+class Obj8BoundsReader {
+public:
+	/** request queues the file at path (which must be a full path) to be
+	 * read.
+	 *
+	 * @returns the request, which is updated when the bounds are ready.
+	 */
+	static std::shared_ptr<Obj8BoundsRequest> request(const std::string &path);
+
+	/** shutdown stops the background thread, failing any requests it
+	 * hadn't got to yet.
+	 */
+	static void shutdown();
+
+	/** readBounds streams the OBJ8 file at path and measures the vertices
+	 * and lights in it.
+	 *
+	 * @returns false if the file couldn't be read or had nothing in it.
+	 */
+	static bool readBounds(const std::string &path, Obj8Bounds &bounds);
+};
+
+#endif //OBJ8BOUNDS_H
@@ -24,6 +24,7 @@
 
 #include "Obj8CSL.h"
 
+#include <algorithm>
 #include <string>
 #include <deque>
 #include <queue>
@@ -129,6 +130,34 @@ Obj8CSL::getModelType() const
 	return "Obj8";
 }
 
+float
+Obj8CSL::getBoundingRadius() const
+{
+	if (mBoundingRadius >= 0.0f) {
+		return mBoundingRadius;
+	}
+
+	// the model covers everything any of its attachments do, so it needs
+	// them all before it can settle.
+	float radius = 0.0f;
+	for (const auto &attachmentSet: mAttachments) {
+		for (const auto &attachment: attachmentSet.second) {
+			Obj8Bounds bounds;
+			switch (attachment->getBounds(bounds)) {
+			case Obj8BoundsState::Pending:
+				return kDefaultBoundingRadius;
+			case Obj8BoundsState::Ready:
+				radius = std::max(radius, bounds.radius);
+				break;
+			case Obj8BoundsState::Failed:
+				break;
+			}
+		}
+	}
+	mBoundingRadius = (radius > 0.0f) ? radius : kDefaultBoundingRadius;
+	return mBoundingRadius;
+}
+
 void
 Obj8CSL::newInstanceData(CSLInstanceData *&newInstanceData) const
 {
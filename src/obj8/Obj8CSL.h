@@ -74,12 +74,18 @@ public:
 
     std::string getModelType() const override;
 
+    /** getBoundingRadius returns the largest radius of the model's
+     * attachments, once they've all been read, and the default until then.
+     */
+    float getBoundingRadius() const override;
+
     static void Init();
     static const char * dref_names[];
 protected:
 
     attachment_map mAttachments;
     std::string mObjectName;     // Basename of the object file
+    mutable float mBoundingRadius = -1.0f;    // cached by getBoundingRadius, negative until known
 
 private:
 
@@ -24,13 +24,17 @@
 
 #include "Obj8InstanceData.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <XPMPMultiplayerVars.h>
 
 #include "Obj8CSL.h"
 
 void
 Obj8InstanceData::updateInstance(
+    const FrameContext &frame,
     CSL *csl,
     double x,
     double y,
@@ -44,11 +48,14 @@ Obj8InstanceData::updateInstance(
     auto *myCSL = dynamic_cast<Obj8CSL *>(csl);
     assert(myCSL != nullptr);
 
-    // determine which instance type we want.
-    //FIXME: use lowlod + lights as appropriate.
+    // determine which instance type we want.  Models without LOW_LOD parts
+    // go straight to their lights, and ones without lights keep the most
+    // detailed parts they have.
+    selectLevelOfDetail(frame);
     Obj8DrawType desiredObj = Obj8DrawType::Solid;
-	auto fullRenderDistance = gConfiguration.maxFullAircraftRenderingDistance * 1000.0f;
-    if (mDistanceSqr > (fullRenderDistance * fullRenderDistance)) {
+    if (mLevelOfDetail == LevelOfDetail::Low && myCSL->hasAttachmentsFor(Obj8DrawType::LowLevelOfDetail)) {
+        desiredObj = Obj8DrawType::LowLevelOfDetail;
+    } else if (mLevelOfDetail != LevelOfDetail::Full) {
         desiredObj = Obj8DrawType::LightsOnly;
         if (!myCSL->hasAttachmentsFor(desiredObj)) {
             desiredObj = Obj8DrawType::LowLevelOfDetail;
@@ -101,24 +108,81 @@ Obj8InstanceData::updateInstance(
         static_cast<float>(lights.strbLights),
         static_cast<float>(lights.navLights)
     };
+    static_assert(sizeof(dataRefValues) == sizeof(mLastValues), "dataref values don't match kDataRefCount");
+
+    // skip the push if nothing's changed since the last one.  A shift in
+    // the local origin moves x, y and z, so that counts as a change too.
+    const bool changed = !mPushed ||
+        objPosition.x != mLastPosition.x ||
+        objPosition.y != mLastPosition.y ||
+        objPosition.z != mLastPosition.z ||
+        objPosition.heading != mLastPosition.heading ||
+        objPosition.pitch != mLastPosition.pitch ||
+        objPosition.roll != mLastPosition.roll ||
+        memcmp(dataRefValues, mLastValues, sizeof(dataRefValues)) != 0;
+
+    long instanceCount = 0;
     for (auto &instanceSet: mInstances) {
         for (auto &instance: instanceSet) {
             if (instance) {
-                XPLMInstanceSetPosition(instance, &objPosition, dataRefValues);
+                if (changed) {
+                    XPLMInstanceSetPosition(instance, &objPosition, dataRefValues);
+                }
+                instanceCount++;
             }
         }
     }
+
+    if (changed) {
+        mPushed = true;
+        mParked = false;
+        mLastPosition = objPosition;
+        memcpy(mLastValues, dataRefValues, sizeof(dataRefValues));
+        gInstanceUpdateStats.pushed += instanceCount;
+        gInstanceUpdateStats.lastFramePushed += instanceCount;
+    } else {
+        gInstanceUpdateStats.skipped += instanceCount;
+        gInstanceUpdateStats.lastFrameSkipped += instanceCount;
+    }
+}
+
+void
+Obj8InstanceData::selectLevelOfDetail(const FrameContext &frame)
+{
+    const float edges[] = {
+        frame.fullRenderDistance * frame.lodScale,
+        frame.lowDetailDistance * frame.lodScale,
+    };
+    const float hysteresis = std::max(gConfiguration.lod.hysteresis, 0.0f);
+
+    // a plane has to get past an edge by the margin to cross it, in either
+    // direction, so one that sits on an edge stays where it is.
+    const float distance = std::sqrt(mDistanceSqr);
+    int level = static_cast<int>(mLevelOfDetail);
+    for (int edge = 0; edge < 2; edge++) {
+        if (level <= edge && distance > edges[edge] * (1.0f + hysteresis)) {
+            level = edge + 1;
+        } else if (level > edge && distance < edges[edge] * (1.0f - hysteresis)) {
+            level = edge;
+            break;
+        }
+    }
+    mLevelOfDetail = static_cast<LevelOfDetail>(level);
 }
 
 void
 Obj8InstanceData::resetPartsForType(const Obj8CSL *, Obj8DrawType drawType)
 {
     const auto instIdx = static_cast<int>(drawType);
-    for (auto &instance: mInstances[instIdx]) {
-        XPLMDestroyInstance(instance);
-        instance = nullptr;
+    auto &instances = mInstances[instIdx];
+    for (unsigned int i = 0; i < instances.size(); i++) {
+        if (instances[i] != nullptr) {
+            mInstanceAttachments[instIdx][i]->releaseInstance(instances[i], mLastValues);
+            instances[i] = nullptr;
+        }
     }
-    mInstances[instIdx].clear();
+    instances.clear();
+    mInstanceAttachments[instIdx].clear();
     mInstanceSetPtrs[instIdx] = nullptr;
 }
 
@@ -138,6 +202,7 @@ Obj8InstanceData::instancePartsForType(const Obj8CSL *csl,
         // flush the instances we need to recreate them as the set has changed.
         resetPartsForType(nullptr, drawType);
         mInstances[instIdx].resize(attSet->size());
+        mInstanceAttachments[instIdx] = *attSet;
         mInstanceSetPtrs[instIdx] = static_cast<const void *>(attSet);
     }
 
@@ -145,13 +210,35 @@ Obj8InstanceData::instancePartsForType(const Obj8CSL *csl,
     const auto &attachments = *attSet;
     for (unsigned int i = 0; i < attachments.size(); i++) {
         if (instances[i] == nullptr) {
-        	auto *objHandle = attachments[i]->getObjectHandle();
-        	if (nullptr != objHandle) {
-				instances[i] = XPLMCreateInstance(attachments[i]->getObjectHandle(),
-					                              Obj8CSL::dref_names);
+            instances[i] = attachments[i]->acquireInstance(Obj8CSL::dref_names);
+            if (instances[i] != nullptr) {
+                mPushed = false;
+            }
+        }
+    }
+}
+
+void
+Obj8InstanceData::parkInstances()
+{
+    // the plane keeps its instances, so coming back into view doesn't have
+    // to create them all again - they're just moved out of sight, and the
+    // next update puts them back.
+    if (mParked) {
+        return;
+    }
+    XPLMDrawInfo_t parked = {};
+    parked.structSize = sizeof(parked);
+    parked.y = Obj8Attachment::kParkedElevation;
+    for (auto &instanceSet: mInstances) {
+        for (auto &instance: instanceSet) {
+            if (instance) {
+                XPLMInstanceSetPosition(instance, &parked, mLastValues);
             }
         }
     }
+    mParked = true;
+    mPushed = false;
 }
 
 void
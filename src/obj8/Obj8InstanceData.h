@@ -29,19 +29,33 @@
 #include <XPLMInstance.h>
 
 #include "Obj8Attachment.h"
+#include "Obj8CSL.h"
 #include "CSL.h"
 
 /** a single renderable instance of a Obj8CSL */
 class Obj8InstanceData : public CSLInstanceData {
 public:
+    /** the number of dataref values pushed with each instance, which must
+     * match Obj8CSL::dref_names */
+    static constexpr int kDataRefCount = 16;
+
     const void *  mInstanceSetPtrs[Obj8DrawTypeCount];
     std::vector<XPLMInstanceRef> mInstances[Obj8DrawTypeCount];
+    /** the attachments mInstances came from, kept so they can be released
+     * back to their pools */
+    Obj8CSL::attachment_array mInstanceAttachments[Obj8DrawTypeCount];
 
     //std::deque<std::pair<Obj8Attachment*,XPLMInstanceRef>>     mInstances;
 
 	Obj8InstanceData():
 	    mInstanceSetPtrs{nullptr,},
-	    mInstances{}
+	    mInstances{},
+	    mInstanceAttachments{},
+	    mLevelOfDetail(LevelOfDetail::Full),
+	    mPushed(false),
+	    mParked(false),
+	    mLastPosition{},
+	    mLastValues{}
     {};
 
 	virtual ~Obj8InstanceData() {
@@ -52,6 +66,7 @@ public:
 
 protected:
 	void updateInstance(
+		const FrameContext &frame,
 		CSL *csl,
 		double x,
 		double y,
@@ -62,10 +77,35 @@ protected:
 		xpmp_LightStatus lights,
 		XPLMPlaneDrawState_t *state) override;
 
+	void parkInstances() override;
+
 	void resetPartsForType(const Obj8CSL *csl, Obj8DrawType drawType);
 	void instancePartsForType(const Obj8CSL *csl, Obj8DrawType drawType);
 
 private:
+	/** the levels of detail, from nearest to furthest. */
+	enum class LevelOfDetail {
+		Full = 0,		// SOLID + LIGHTS
+		Low,			// LOW_LOD + LIGHTS
+		LightsOnly		// LIGHTS
+	};
+
+	/** the level of detail the plane is drawn at, kept between frames so the
+	 * band edges can have some hysteresis */
+	LevelOfDetail	mLevelOfDetail;
+
+	/** selectLevelOfDetail moves mLevelOfDetail to the band the plane is in,
+	 * once it's more than the hysteresis margin across a band's edge. */
+	void selectLevelOfDetail(const FrameContext &frame);
+
+	/** true if every instance has been given mLastPosition and mLastValues.
+	 * Cleared when instances are created, so they get their first update. */
+	bool			mPushed;
+	/** true while the instances are parked out of sight by parkInstances */
+	bool			mParked;
+	XPLMDrawInfo_t	mLastPosition;
+	float			mLastValues[kDataRefCount];
+
 	void resetModel();
 };
 